@@ -6,9 +6,524 @@
  */
 
 #include "ILI9341.h"
+#include "ILI9341_Profile.h"
+#include "ILI9341_Indexed.h"
+#include "ILI9341_Memory.h"
 volatile uint16_t LCD_HEIGHT = ILI9341_SCREEN_HEIGHT;
 volatile uint16_t LCD_WIDTH	 = ILI9341_SCREEN_WIDTH;
 
+/*DMA transport state - shared between the drawing calls and the SPI2 TX complete callback*/
+static volatile uint8_t		dma_busy = 0;		//a DMA transfer owns the bus (CS low)
+static const uint8_t*		dma_source;			//start of the next chunk
+static volatile uint32_t	dma_remaining = 0;	//frames still to be queued after the current chunk
+static uint32_t				dma_chunk_max;		//largest chunk handed to HAL_SPI_Transmit_DMA
+static uint32_t				dma_step;			//source advance per chunk, 0 repeats the same block
+static uint8_t				bus_mode = ILI9341_BUS_8BIT;
+static uint16_t				fill_colour;		//source word of the memory-increment-disabled fill DMA
+
+static volatile uint8_t		dma_notify = 0;		//call ILI9341_Transfer_Complete_Callback when the transfer ends
+static volatile uint8_t		cs_hold = 0;		//nesting depth of ILI9341_Begin_Write, CS stays low while non-zero
+static volatile ILI9341_Traffic_TypeDef traffic;	//running bus counters, see ILI9341_Get_Traffic
+
+/*Transfer buffer pool, see ILI9341_Acquire_Buffer*/
+#define TRANSFER_FREE			0
+#define TRANSFER_OWNED			1		//acquired, the CPU may fill it
+#define TRANSFER_SENDING		2		//on the bus, back to TRANSFER_OWNED when sent
+#define TRANSFER_SENDING_FREE	3		//on the bus, back to TRANSFER_FREE when sent
+#define TRANSFER_NONE			0xFF
+static uint8_t	transfer_buffer[ILI9341_TRANSFER_BUFFERS][ILI9341_DMA_BUFFER_SIZE] ILI9341_DMA_RAM;
+static volatile uint8_t	transfer_state[ILI9341_TRANSFER_BUFFERS];	//written by the CPU, and by the SPI interrupt when sent
+static volatile uint8_t	transfer_sending = TRANSFER_NONE;			//pool buffer of the running DMA transfer
+static uint8_t*	back_buffer = NULL;				//buffer handed out by ILI9341_Get_Back_Buffer
+static ILI9341_Transfer_Stats_TypeDef transfer_stats = {ILI9341_TRANSFER_BUFFERS, 0, 0, 0, 0};
+
+/*Shadow of the controller address window, used to skip redundant CASET/PASET/RAMWR*/
+#define WINDOW_COLUMNS_VALID	0x01
+#define WINDOW_PAGES_VALID		0x02
+static uint8_t		window_valid = 0;
+static uint16_t		window_x1, window_x2, window_y1, window_y2;
+static uint32_t		window_area = 0;		//pixels in the current window
+static uint32_t		write_offset = 0;		//write pointer, in pixels from the window start
+static uint8_t		ram_write_open = 0;		//RAMWR sent and not ended by another command
+static ILI9341_Window_Stats_TypeDef window_stats;
+
+static ILI9341_Boot_Times_TypeDef boot_times;
+
+static uint32_t		pixel_keys[ILI9341_PIXELS_BATCH] ILI9341_CCMRAM;	//sort buffer of ILI9341_Draw_Pixels, (Y << 16) | X
+
+/*Power-up state machine, see ILI9341_Init_Poll*/
+#define ILI9341_INIT_RESET_PULSE	0
+#define ILI9341_INIT_RESET_RECOVERY	1
+#define ILI9341_INIT_TABLE			2
+#define ILI9341_INIT_WAIT			3
+#define ILI9341_INIT_DONE			4
+static uint8_t			init_state = ILI9341_INIT_DONE;
+static const uint8_t*	init_table;				//next init table entry
+static uint8_t			init_command;			//command whose delay is running
+static uint16_t			init_delay;				//table delay of that command, in ms
+static uint32_t			init_wait_start;		//HAL tick when the current wait began
+static uint32_t			init_wait_cycles;		//cycle counter when the current wait began
+static uint32_t			init_last_poll;			//tick offset of the last status read
+static uint32_t			init_start_cycles;
+
+/**
+ * @brief  Ends a bus transaction by releasing CS, unless a write transaction
+ *         opened with ILI9341_Begin_Write keeps the display selected.
+ */
+static void ILI9341_CS_Release(void)
+{
+	if(cs_hold == 0)
+	{
+		HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_SET);
+	}
+}
+
+/**
+ * @brief  Advances the shadow write pointer after pixel data was sent.
+ * @param  Pixels: Number of pixels written into the current window.
+ * 
+ * The controller wraps the pointer back to the window start when the window
+ * is full, so the shadow is kept modulo the window area.
+ */
+static void ILI9341_Advance_Write_Pointer(uint32_t Pixels)
+{
+	traffic.Pixels += Pixels;
+	if(window_area != 0)
+	{
+		write_offset = (write_offset + Pixels) % window_area;
+	}
+}
+
+/**
+ * @brief  Queues the next chunk of the active DMA transfer.
+ * 
+ * Called once to start a transfer and then from the SPI TX complete callback
+ * until all bytes are sent. All state is updated before the DMA is started,
+ * so the callback may fire at any point after HAL_SPI_Transmit_DMA.
+ */
+static ILI9341_RAMFUNC void ILI9341_DMA_Next_Chunk(void)
+{
+	uint32_t chunk = dma_remaining;
+	if(chunk > dma_chunk_max)
+	{
+		chunk = dma_chunk_max;
+	}
+	const uint8_t* source = dma_source;
+	dma_source += dma_step;
+	dma_remaining -= chunk;
+	HAL_SPI_Transmit_DMA(&hspi2, (uint8_t*)source, chunk);
+}
+
+/**
+ * @brief  Starts a DMA transfer of pixel data on SPI2.
+ * @param  Source: First frame to send.
+ * @param  Size: Total number of SPI frames to send (bytes or 16-bit words, see ILI9341_Bus_Mode).
+ * @param  Chunk_Max: Largest chunk per DMA request (at most ILI9341_DMA_MAX_TRANSFER).
+ * @param  Step: Source advance in bytes per chunk, 0 to resend the same block every chunk.
+ * @retval None
+ * 
+ * The bus must already be idle and in the wanted mode. The data/command pin is
+ * set to data and CS stays low until the last chunk completes. The function
+ * returns as soon as the first chunk is started. A source in CCM RAM, which
+ * the DMA cannot read, is sent with blocking transfers instead.
+ */
+static ILI9341_RAMFUNC void ILI9341_DMA_Start(const uint8_t* Source, uint32_t Size, uint32_t Chunk_Max, uint32_t Step)
+{
+	if(Size == 0) return;
+
+	dma_source = Source;
+	dma_remaining = Size;
+	dma_chunk_max = Chunk_Max;
+	dma_step = Step;
+	dma_busy = 1;
+	traffic.Bytes += (bus_mode == ILI9341_BUS_16BIT_FILL) ? Size * 2 : Size;
+
+	HAL_GPIO_WritePin(DC_GPIO_Port, DC_Pin, GPIO_PIN_SET);
+	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
+	if(!ILI9341_DMA_REACHABLE(Source))
+	{
+		//CCM RAM is not on the DMA bus: same chunks, sent by the CPU
+		while(dma_remaining != 0)
+		{
+			uint32_t chunk = (dma_remaining > dma_chunk_max) ? dma_chunk_max : dma_remaining;
+			HAL_SPI_Transmit(&hspi2, (uint8_t*)dma_source, chunk, HAL_MAX_DELAY);
+			dma_source += dma_step;
+			dma_remaining -= chunk;
+		}
+		HAL_SPI_TxCpltCallback(&hspi2);
+		return;
+	}
+	ILI9341_DMA_Next_Chunk();
+}
+
+/**
+ * @brief  SPI TX complete callback, chains the remaining chunks of a DMA transfer.
+ * @param  hspi: SPI handle that finished transmitting.
+ * @retval None
+ * 
+ * Overrides the weak HAL implementation. When the last chunk is done the chip
+ * select is released and the bus is marked idle.
+ */
+ILI9341_RAMFUNC void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+	if(hspi != &hspi2) return;
+
+	if(dma_remaining != 0)
+	{
+		ILI9341_DMA_Next_Chunk();
+		return;
+	}
+	ILI9341_CS_Release();
+	if(transfer_sending != TRANSFER_NONE)
+	{
+		uint8_t i = transfer_sending;
+		transfer_state[i] = (transfer_state[i] == TRANSFER_SENDING_FREE) ? TRANSFER_FREE : TRANSFER_OWNED;
+		transfer_sending = TRANSFER_NONE;
+	}
+	dma_busy = 0;
+	if(dma_notify)
+	{
+		dma_notify = 0;
+		ILI9341_Transfer_Complete_Callback();
+	}
+}
+
+/**
+ * @brief  Called when a ILI9341_Transmit_DMA transfer (e.g. ILI9341_Draw_Image)
+ *         has been completely sent.
+ * @retval None
+ * 
+ * Runs from HAL_SPI_TxCpltCallback, i.e. in DMA1_Stream4_IRQHandler, or
+ * synchronously from inside ILI9341_Transmit_DMA when the source is in CCM RAM
+ * and the CPU sent it. The bus is already idle, but the main loop may be in
+ * the middle of a driver call: only set a flag or signal a task from here.
+ * Do not call drawing functions or any other ILI9341 API, the bus state is
+ * not locked and the ILI9341_Profile call-depth tracking is not reentrant.
+ * This function should not be modified, when the callback is needed,
+ * ILI9341_Transfer_Complete_Callback can be implemented in the user file.
+ */
+__weak void ILI9341_Transfer_Complete_Callback(void)
+{
+}
+
+/**
+ * @brief  Reports whether a DMA transfer is still running on the display bus.
+ * @retval 1 while a transfer is in progress, 0 when the bus is idle.
+ */
+uint8_t ILI9341_Is_Busy(void)
+{
+	return dma_busy;
+}
+
+/**
+ * @brief  Blocks until the running DMA transfer (if any) has completed.
+ * 
+ * Every function that touches CS, DC or the SPI peripheral calls this first,
+ * so blocking and DMA drawing calls can be freely mixed.
+ */
+void ILI9341_Wait_Idle(void)
+{
+	while(dma_busy)
+	{
+	}
+}
+
+/* Bus traffic counters */
+/**
+ * @brief  Copies the running count of bytes and pixels sent to the display.
+ * @param  Traffic: Destination.
+ * @retval None
+ *
+ * The counters are never reset and wrap at 2^32; take differences for a
+ * measurement. DMA transfers are counted in full when they are started.
+ */
+void ILI9341_Get_Traffic(ILI9341_Traffic_TypeDef* Traffic)
+{
+	*Traffic = traffic;
+}
+
+/**
+ * @brief  Opens a write transaction: CS stays low until the matching ILI9341_End_Write.
+ * 
+ * Transactions nest, only the outermost pair touches CS. Commands, address
+ * windows and pixel data sent in between still toggle DC but skip the CS
+ * edges, so a batch of small writes goes out as one CS assertion.
+ */
+void ILI9341_Begin_Write(void)
+{
+	ILI9341_Wait_Idle();
+	if(cs_hold++ == 0)
+	{
+		HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
+	}
+}
+
+/**
+ * @brief  Closes a write transaction opened with ILI9341_Begin_Write.
+ * 
+ * The outermost call waits for any DMA transfer still running and then
+ * releases CS.
+ */
+void ILI9341_End_Write(void)
+{
+	ILI9341_Wait_Idle();
+	if(cs_hold == 0) return;
+	if(--cs_hold == 0)
+	{
+		HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_SET);
+	}
+}
+
+/**
+ * @brief  Streams a block of pixel data to the display using DMA.
+ * @param  Data: Pixel data in display byte order (RGB565, high byte first).
+ * @param  Size: Number of bytes to send.
+ * @retval None
+ * 
+ * The data is sent straight from its location (RAM or flash) in chunks of up to
+ * ILI9341_DMA_MAX_TRANSFER bytes. The call returns immediately; Data must stay
+ * valid until ILI9341_Is_Busy() returns 0 or ILI9341_Transfer_Complete_Callback
+ * is called.
+ */
+void ILI9341_Transmit_DMA(const uint8_t* Data, uint32_t Size)
+{
+	ILI9341_PROFILE_FUNCTION(Transmit_DMA);
+	ILI9341_Wait_Idle();
+	ILI9341_Bus_Mode(ILI9341_BUS_8BIT);
+	ILI9341_Advance_Write_Pointer(Size/2);
+	dma_notify = 1;
+	ILI9341_DMA_Start(Data, Size, ILI9341_DMA_MAX_TRANSFER, ILI9341_DMA_MAX_TRANSFER);
+}
+
+/**
+ * @brief  Streams a rectangle of pixel rows to the display using DMA.
+ * @param  Data: First byte of the first row, in display byte order.
+ * @param  Row_Size: Bytes sent per row.
+ * @param  Rows: Number of rows.
+ * @param  Stride: Distance in bytes between the starts of two source rows.
+ * @retval None
+ * 
+ * One DMA request is queued per row, each started from the completion
+ * interrupt of the previous one, so a sub-rectangle of a larger image goes
+ * out without copying. When the rows are contiguous (Stride == Row_Size) the
+ * whole block is sent in maximum-length chunks instead. Same rules as
+ * ILI9341_Transmit_DMA: the call returns immediately, the source must stay
+ * valid until the transfer completes, and ILI9341_Transfer_Complete_Callback
+ * is called at the end.
+ */
+void ILI9341_Transmit_DMA_Rows(const uint8_t* Data, uint32_t Row_Size, uint32_t Rows, uint32_t Stride)
+{
+	ILI9341_PROFILE_FUNCTION(Transmit_DMA_Rows);
+	if(Stride == Row_Size)
+	{
+		ILI9341_Transmit_DMA(Data, Row_Size*Rows);
+		return;
+	}
+	if((Row_Size == 0) || (Rows == 0)) return;
+
+	ILI9341_Wait_Idle();
+	ILI9341_Bus_Mode(ILI9341_BUS_8BIT);
+	ILI9341_Advance_Write_Pointer(Row_Size*Rows/2);
+	dma_notify = 1;
+	ILI9341_DMA_Start(Data, Row_Size*Rows, Row_Size, Stride);
+}
+
+/* Transfer buffer pool */
+/**
+ * @brief  Takes a transfer buffer from the pool.
+ * @retval ILI9341_DMA_BUFFER_SIZE bytes of DMA-reachable SRAM, 4-byte aligned;
+ *         NULL when every buffer is held by the caller.
+ * 
+ * When all buffers are in use but one is on the bus and due back to the
+ * pool, waits for that transfer. The buffer stays the caller's until it is
+ * sent with ILI9341_BUFFER_RELEASE or given back with ILI9341_Release_Buffer,
+ * so a buffer filled once can be sent any number of times.
+ */
+uint8_t* ILI9341_Acquire_Buffer(void)
+{
+	ILI9341_PROFILE_FUNCTION(Acquire_Buffer);
+	for(;;)
+	{
+		uint8_t returning = 0;
+		uint32_t in_use = 1;
+
+		for(uint8_t i = 0; i < ILI9341_TRANSFER_BUFFERS; i++)
+		{
+			if(transfer_state[i] != TRANSFER_FREE)
+			{
+				in_use++;
+				returning |= (transfer_state[i] == TRANSFER_SENDING_FREE);
+			}
+		}
+		for(uint8_t i = 0; i < ILI9341_TRANSFER_BUFFERS; i++)
+		{
+			if(transfer_state[i] == TRANSFER_FREE)
+			{
+				transfer_state[i] = TRANSFER_OWNED;
+				if(in_use > transfer_stats.Peak)
+				{
+					transfer_stats.Peak = in_use;
+				}
+				return transfer_buffer[i];
+			}
+		}
+		if(!returning)
+		{
+			transfer_stats.Failures++;
+			return NULL;
+		}
+		transfer_stats.Waits++;
+		ILI9341_Wait_Idle();
+	}
+}
+
+/**
+ * @brief  Returns the pool index of a transfer buffer, TRANSFER_NONE if it is not one.
+ */
+static uint8_t ILI9341_Buffer_Index(const uint8_t* Buffer)
+{
+	for(uint8_t i = 0; i < ILI9341_TRANSFER_BUFFERS; i++)
+	{
+		if(Buffer == transfer_buffer[i]) return i;
+	}
+	return TRANSFER_NONE;
+}
+
+/**
+ * @brief  Sends the start of an acquired transfer buffer using DMA.
+ * @param  Buffer: Buffer from ILI9341_Acquire_Buffer.
+ * @param  Size: Number of bytes to send.
+ * @param  Release: ILI9341_BUFFER_RELEASE to return the buffer to the pool
+ *                  from the SPI interrupt once sent, ILI9341_BUFFER_KEEP to
+ *                  keep it (resident data sent again later).
+ * @retval None
+ * 
+ * Waits for the previous transfer, starts this one and returns. A kept
+ * buffer must not be written before the transfer ends (ILI9341_Wait_Idle).
+ */
+void ILI9341_Send_Buffer(uint8_t* Buffer, uint32_t Size, uint8_t Release)
+{
+	ILI9341_PROFILE_FUNCTION(Send_Buffer);
+	uint8_t i = ILI9341_Buffer_Index(Buffer);
+
+	if(i == TRANSFER_NONE) return;
+	ILI9341_Wait_Idle();
+	if(Size == 0)
+	{
+		if(Release) transfer_state[i] = TRANSFER_FREE;
+		return;
+	}
+	ILI9341_Bus_Mode(ILI9341_BUS_8BIT);
+	ILI9341_Advance_Write_Pointer(Size/2);
+	transfer_state[i] = Release ? TRANSFER_SENDING_FREE : TRANSFER_SENDING;
+	transfer_sending = i;
+	ILI9341_DMA_Start(Buffer, Size, ILI9341_DMA_MAX_TRANSFER, ILI9341_DMA_MAX_TRANSFER);
+}
+
+/**
+ * @brief  Gives a kept buffer back to the pool, waiting first if it is still on the bus.
+ * @param  Buffer: Buffer from ILI9341_Acquire_Buffer.
+ * @retval None
+ */
+void ILI9341_Release_Buffer(uint8_t* Buffer)
+{
+	ILI9341_PROFILE_FUNCTION(Release_Buffer);
+	uint8_t i = ILI9341_Buffer_Index(Buffer);
+
+	if(i == TRANSFER_NONE) return;
+	if(transfer_state[i] >= TRANSFER_SENDING)
+	{
+		ILI9341_Wait_Idle();
+	}
+	transfer_state[i] = TRANSFER_FREE;
+}
+
+/**
+ * @brief  Copies the usage counters of the transfer buffer pool.
+ * @param  Stats: Destination.
+ * @retval None
+ */
+void ILI9341_Get_Transfer_Stats(ILI9341_Transfer_Stats_TypeDef* Stats)
+{
+	*Stats = transfer_stats;
+	Stats->In_Use = 0;
+	for(uint8_t i = 0; i < ILI9341_TRANSFER_BUFFERS; i++)
+	{
+		Stats->In_Use += (transfer_state[i] != TRANSFER_FREE);
+	}
+}
+
+/**
+ * @brief  Returns the transfer buffer the CPU may fill next.
+ * @retval Pointer to ILI9341_DMA_BUFFER_SIZE bytes.
+ * 
+ * Acquires a buffer from the pool on the first call after each
+ * ILI9341_Send_Back_Buffer. It is never the one being sent, so the next band
+ * can be rendered into it while the previous band is still on the wire.
+ * Returns NULL only if the caller holds every buffer of the pool (see
+ * ILI9341_Acquire_Buffer), so callers check the first call of a drawing and
+ * give up before touching the bus. Once one buffer was obtained, the calls
+ * after each ILI9341_Send_Back_Buffer wait for it to come back instead.
+ */
+uint8_t* ILI9341_Get_Back_Buffer(void)
+{
+	if(back_buffer == NULL)
+	{
+		back_buffer = ILI9341_Acquire_Buffer();
+	}
+	return back_buffer;
+}
+
+/**
+ * @brief  Sends the back buffer using DMA and returns it to the pool once sent.
+ * @param  Size: Number of bytes of the back buffer to send.
+ * @retval None
+ * 
+ * Waits for the previous transfer, starts the new one and returns, so the
+ * caller can immediately fill the next buffer.
+ */
+void ILI9341_Send_Back_Buffer(uint32_t Size)
+{
+	uint8_t* buffer = ILI9341_Get_Back_Buffer();
+
+	back_buffer = NULL;
+	ILI9341_Send_Buffer(buffer, Size, ILI9341_BUFFER_RELEASE);
+}
+
+/**
+ * @brief  Switches SPI2 and its TX DMA stream between 8-bit and 16-bit fill framing.
+ * @param  Mode: ILI9341_BUS_8BIT or ILI9341_BUS_16BIT_FILL.
+ * @retval None
+ * 
+ * In ILI9341_BUS_16BIT_FILL the SPI sends 16-bit frames (MSB first, so RGB565
+ * goes out in display byte order) and the DMA reads the same half-word over and
+ * over. The peripherals are only reconfigured when the mode actually changes,
+ * so a run of fills or a run of commands pays for the switch once.
+ */
+void ILI9341_Bus_Mode(uint8_t Mode)
+{
+	if(Mode == bus_mode) return;
+	ILI9341_Wait_Idle();
+
+	if(Mode == ILI9341_BUS_16BIT_FILL)
+	{
+		hspi2.Init.DataSize = SPI_DATASIZE_16BIT;
+		hdma_spi2_tx.Init.MemInc = DMA_MINC_DISABLE;
+		hdma_spi2_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+		hdma_spi2_tx.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+	}
+	else
+	{
+		hspi2.Init.DataSize = SPI_DATASIZE_8BIT;
+		hdma_spi2_tx.Init.MemInc = DMA_MINC_ENABLE;
+		hdma_spi2_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+		hdma_spi2_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+	}
+	HAL_SPI_Init(&hspi2);
+	HAL_DMA_Init(&hdma_spi2_tx);
+	bus_mode = Mode;
+}
+
 /**
  * @brief  Initializes the ILI9341 display by setting the chip select pin to low.
  * 
@@ -19,6 +534,7 @@ volatile uint16_t LCD_WIDTH	 = ILI9341_SCREEN_WIDTH;
  *        defined and initialized before calling this function.
  */
 void ILI9341_SPI_init(void){
+		ILI9341_Wait_Idle();
 		HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
 
 }
@@ -28,6 +544,8 @@ void ILI9341_SPI_init(void){
  * @retval None
  */
 void ILI9341_SPI_SEND(unsigned char SPI_Data){
+	ILI9341_Bus_Mode(ILI9341_BUS_8BIT);
+	traffic.Bytes++;
 	HAL_SPI_Transmit(&hspi2, &SPI_Data, 1, 1);
 }
 
@@ -42,10 +560,51 @@ void ILI9341_SPI_SEND(unsigned char SPI_Data){
  */
 void ILI9341_Write_Command(uint8_t Command)
 {
+	ILI9341_Write_Command_Params(Command, NULL, 0);
+}
+
+/* Send command and its parameters to LCD in one transaction */
+/**
+ * @brief  Sends a command and all of its parameter bytes in a single CS assertion.
+ * @param  Command: The command byte.
+ * @param  Params: Parameter bytes, may be NULL when Length is 0.
+ * @param  Length: Number of parameter bytes.
+ * @retval None
+ *
+ * DC is low for the command byte and high for the parameters, which go out in
+ * one HAL_SPI_Transmit. Any command ends a pending memory write, and commands
+ * that change the address window outside of ILI9341_Set_Address drop the
+ * matching part of the window shadow.
+ */
+void ILI9341_Write_Command_Params(uint8_t Command, const uint8_t* Params, uint16_t Length)
+{
+	ILI9341_Wait_Idle();
+	ILI9341_Bus_Mode(ILI9341_BUS_8BIT);
+
+	ram_write_open = 0;
+	if(Command == 0x2A)
+	{
+		window_valid &= ~WINDOW_COLUMNS_VALID;
+	}
+	else if(Command == 0x2B)
+	{
+		window_valid &= ~WINDOW_PAGES_VALID;
+	}
+	else if(Command == 0x01)
+	{
+		window_valid = 0;
+	}
+
+	traffic.Bytes += 1 + Length;
 	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
 	HAL_GPIO_WritePin(DC_GPIO_Port, DC_Pin, GPIO_PIN_RESET);
-	ILI9341_SPI_SEND(Command);
-	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_SET);
+	HAL_SPI_Transmit(&hspi2, &Command, 1, 1);
+	if(Length != 0)
+	{
+		HAL_GPIO_WritePin(DC_GPIO_Port, DC_Pin, GPIO_PIN_SET);
+		HAL_SPI_Transmit(&hspi2, (uint8_t*)Params, Length, 10);
+	}
+	ILI9341_CS_Release();
 }
 
 /* Send Data (char) to LCD */
@@ -60,10 +619,60 @@ void ILI9341_Write_Command(uint8_t Command)
  */
 void ILI9341_Write_Data(uint8_t Data)
 {
+	ILI9341_Wait_Idle();
+	ram_write_open = 0;		//a raw byte inside RAMWR leaves the write pointer unknown
 	HAL_GPIO_WritePin(DC_GPIO_Port, DC_Pin, GPIO_PIN_SET);
 	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
 	ILI9341_SPI_SEND(Data);
-	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_SET);
+	ILI9341_CS_Release();
+}
+
+/* Read 8-bit register from LCD */
+/**
+ * @brief  Reads a single-byte register (e.g. 0x0A, display power mode) over MISO.
+ * @param  Command: Read command to send.
+ * @retval The byte returned by the display.
+ *
+ * The ILI9341 serial read cycle is limited to about 6.6 MHz, so SPI2 is slowed
+ * down for the read and restored afterwards. Only the 8-bit read commands
+ * (0x0A-0x0F) are supported; they need no dummy clock in 4-line mode.
+ */
+uint8_t ILI9341_Read_Register(uint8_t Command)
+{
+	ILI9341_PROFILE_FUNCTION(Read_Register);
+	uint8_t value = 0;
+	uint32_t prescaler = hspi2.Init.BaudRatePrescaler;
+
+	ILI9341_Wait_Idle();
+	ILI9341_Bus_Mode(ILI9341_BUS_8BIT);
+	ram_write_open = 0;
+
+	hspi2.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_8;
+	HAL_SPI_Init(&hspi2);
+
+	traffic.Bytes += 2;
+	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
+	HAL_GPIO_WritePin(DC_GPIO_Port, DC_Pin, GPIO_PIN_RESET);
+	HAL_SPI_Transmit(&hspi2, &Command, 1, 1);
+	HAL_GPIO_WritePin(DC_GPIO_Port, DC_Pin, GPIO_PIN_SET);
+	HAL_SPI_Receive(&hspi2, &value, 1, 1);
+	ILI9341_CS_Release();
+
+	hspi2.Init.BaudRatePrescaler = prescaler;
+	HAL_SPI_Init(&hspi2);
+	return value;
+}
+
+/**
+ * @brief  Sends an address command followed by its two 16-bit parameters.
+ * @param  Command: 0x2A (column address set) or 0x2B (page address set).
+ * @param  Start: First column/page of the window.
+ * @param  End: Last column/page of the window.
+ */
+static void ILI9341_Write_Address_Pair(uint8_t Command, uint16_t Start, uint16_t End)
+{
+	uint8_t Temp_Buffer[4] = {Start>>8, Start, End>>8, End};
+	ILI9341_Write_Command_Params(Command, Temp_Buffer, 4);
 }
 
 /**
@@ -73,6 +682,15 @@ void ILI9341_Write_Data(uint8_t Data)
  * will take place on the ILI9341 display. The area is defined by the coordinates
  * (X1, Y1) for the top-left corner and (X2, Y2) for the bottom-right corner.
  *
+ * A shadow of the controller window is kept: the column (0x2A) and page (0x2B)
+ * ranges are only sent when they differ from the last ones, and the memory
+ * write (0x2C) is skipped too when the window is unchanged, no other command
+ * was sent since, and the write pointer has wrapped back to the window start.
+ *
+ * In ILI9341_RENDER_INDEXED mode the window is only recorded for the next
+ * ILI9341_Draw_Colour_Burst into the framebuffer; nothing is sent and the
+ * shadow keeps describing the panel.
+ *
  * @param X1 The X coordinate of the top-left corner.
  * @param Y1 The Y coordinate of the top-left corner.
  * @param X2 The X coordinate of the bottom-right corner.
@@ -80,40 +698,130 @@ void ILI9341_Write_Data(uint8_t Data)
  */
 /* Set Address - Location block - to draw into */
 void ILI9341_Set_Address(uint16_t X1, uint16_t Y1, uint16_t X2, uint16_t Y2)
+{
+#if ILI9341_INDEXED
+	if(ILI9341_Get_Render_Mode() == ILI9341_RENDER_INDEXED)
 	{
-	ILI9341_Write_Command(0x2A);
-	ILI9341_Write_Data(X1>>8);
-	ILI9341_Write_Data(X1);
-	ILI9341_Write_Data(X2>>8);
-	ILI9341_Write_Data(X2);
+		ILI9341_Indexed_Set_Window(X1, Y1, X2, Y2);
+		return;
+	}
+#endif
+	ILI9341_Set_Panel_Address(X1, Y1, X2, Y2);
+}
 
-	ILI9341_Write_Command(0x2B);
-	ILI9341_Write_Data(Y1>>8);
-	ILI9341_Write_Data(Y1);
-	ILI9341_Write_Data(Y2>>8);
-	ILI9341_Write_Data(Y2);
+/**
+ * @brief  Sets the controller address window, whatever the render mode.
+ * @param  X1: Left column.
+ * @param  Y1: Top row.
+ * @param  X2: Right column.
+ * @param  Y2: Bottom row.
+ * @retval None
+ *
+ * Same as ILI9341_Set_Address in the direct mode. For the renderers that
+ * produce their own pixels and always send them to the panel
+ * (ILI9341_Band_End, ILI9341_Indexed_Flush).
+ */
+void ILI9341_Set_Panel_Address(uint16_t X1, uint16_t Y1, uint16_t X2, uint16_t Y2)
+{
+	uint8_t changed = 0;
+	window_stats.Windows++;
+
+	if(!(window_valid & WINDOW_COLUMNS_VALID) || (X1 != window_x1) || (X2 != window_x2))
+	{
+		ILI9341_Write_Address_Pair(0x2A, X1, X2);
+		window_x1 = X1;
+		window_x2 = X2;
+		window_valid |= WINDOW_COLUMNS_VALID;
+		changed = 1;
+	}
+	else
+	{
+		window_stats.Column_Skipped++;
+		window_stats.Bytes_Saved += 5;
+	}
 
-	ILI9341_Write_Command(0x2C);
+	if(!(window_valid & WINDOW_PAGES_VALID) || (Y1 != window_y1) || (Y2 != window_y2))
+	{
+		ILI9341_Write_Address_Pair(0x2B, Y1, Y2);
+		window_y1 = Y1;
+		window_y2 = Y2;
+		window_valid |= WINDOW_PAGES_VALID;
+		changed = 1;
+	}
+	else
+	{
+		window_stats.Page_Skipped++;
+		window_stats.Bytes_Saved += 5;
+	}
+
+	if(changed || !ram_write_open || (write_offset != 0))
+	{
+		ILI9341_Write_Command(0x2C);
+		ram_write_open = 1;
+		write_offset = 0;
+	}
+	else
+	{
+		window_stats.Write_Skipped++;
+		window_stats.Bytes_Saved += 1;
+	}
+	window_area = (uint32_t)(X2-X1+1)*(Y2-Y1+1);
+}
+
+/**
+ * @brief  Forgets the shadow of the controller address window.
+ * 
+ * The next ILI9341_Set_Address sends the full CASET/PASET/RAMWR sequence. Call
+ * this after talking to the controller directly (e.g. raw HAL_SPI_Transmit
+ * pixel data) so the shadow cannot go stale.
+ */
+void ILI9341_Invalidate_Window(void)
+{
+	window_valid = 0;
+	ram_write_open = 0;
+}
+
+/**
+ * @brief  Copies the address window cache counters.
+ * @param  Stats: Destination for the counters.
+ */
+void ILI9341_Get_Window_Stats(ILI9341_Window_Stats_TypeDef* Stats)
+{
+	*Stats = window_stats;
+}
+
+/**
+ * @brief  Clears the address window cache counters.
+ */
+void ILI9341_Reset_Window_Stats(void)
+{
+	ILI9341_Window_Stats_TypeDef cleared = {0};
+	window_stats = cleared;
 }
+
 /*HARDWARE RESET*/
 /**
  * @brief  Resets the ILI9341 display.
  * 
  * This function performs a hardware reset on the ILI9341 display by toggling
- * the RESET and CHIP_SELECT pins. It first pulls the RESET pin low, waits for
- * 200 milliseconds, then pulls the CHIP_SELECT pin low, waits for another 200
- * milliseconds, and finally pulls the RESET pin high to complete the reset process.
+ * the RESET and CHIP_SELECT pins. It pulls the RESET and CHIP_SELECT pins low,
+ * waits ILI9341_RESET_PULSE_MS, pulls the RESET pin high and waits
+ * ILI9341_RESET_RECOVERY_MS before the display accepts commands. With
+ * ILI9341_FAST_INIT these are the datasheet minimums, otherwise the legacy 400 ms.
  * 
  * @note This function uses HAL (Hardware Abstraction Layer) functions to control
  *       the GPIO pins and introduce delays.
  */
 void ILI9341_Reset(void)
 {
+	ILI9341_PROFILE_FUNCTION(Reset);
+	ILI9341_Wait_Idle();
+	ILI9341_Invalidate_Window();
 	HAL_GPIO_WritePin(RESET_GPIO_Port, RESET_Pin, GPIO_PIN_RESET);
-	HAL_Delay(200);
 	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
-	HAL_Delay(200);
+	HAL_Delay(ILI9341_RESET_PULSE_MS);
 	HAL_GPIO_WritePin(RESET_GPIO_Port, RESET_Pin, GPIO_PIN_SET);
+	HAL_Delay(ILI9341_RESET_RECOVERY_MS);
 }
 
 /*Ser rotation of the screen - changes x0 and y0*/
@@ -128,37 +836,39 @@ void ILI9341_Reset(void)
  */
 void ILI9341_Set_Rotation(uint8_t Rotation)
 {
+	ILI9341_PROFILE_FUNCTION(Set_Rotation);
 
 	uint8_t screen_rotation = Rotation;
-	ILI9341_Write_Command(0x36);
-	HAL_Delay(1);
+	uint8_t madctl;
+	ILI9341_Invalidate_Window();
 
 	switch(screen_rotation)
 		{
 			case SCREEN_VERTICAL_1:
-				ILI9341_Write_Data(0x40|0x08);
+				madctl = 0x40|0x08;
 				LCD_WIDTH = 240;
 				LCD_HEIGHT = 320;
 				break;
 			case SCREEN_HORIZONTAL_1:
-				ILI9341_Write_Data(0x20|0x08);
+				madctl = 0x20|0x08;
 				LCD_WIDTH  = 320;
 				LCD_HEIGHT = 240;
 				break;
 			case SCREEN_VERTICAL_2:
-				ILI9341_Write_Data(0x80|0x08);
+				madctl = 0x80|0x08;
 				LCD_WIDTH  = 240;
 				LCD_HEIGHT = 320;
 				break;
 			case SCREEN_HORIZONTAL_2:
-				ILI9341_Write_Data(0x40|0x80|0x20|0x08);
+				madctl = 0x40|0x80|0x20|0x08;
 				LCD_WIDTH  = 320;
 				LCD_HEIGHT = 240;
 				break;
 			default:
 				//EXIT IF SCREEN ROTATION NOT VALID!
-				break;
+				return;
 		}
+	ILI9341_Write_Command_Params(0x36, &madctl, 1);
 }
 /*Enable LCD display*/
 /**
@@ -177,15 +887,255 @@ HAL_GPIO_WritePin(RESET_GPIO_Port, RESET_Pin, GPIO_PIN_SET);
 }
 
 
+/*Power-up register sequence of the ILI9341, see ILI9341_Run_Init_Table for the format*/
+static const uint8_t ILI9341_Init_Sequence[] = {
+	0x01, ILI9341_INIT_DELAY, 0x03, 0xE8,					//SOFTWARE RESET, 1000 ms
+	0xCB, 5, 0x39, 0x2C, 0x00, 0x34, 0x02,					//POWER CONTROL A
+	0xCF, 3, 0x00, 0xC1, 0x30,								//POWER CONTROL B
+	0xE8, 3, 0x85, 0x00, 0x78,								//DRIVER TIMING CONTROL A
+	0xEA, 2, 0x00, 0x00,									//DRIVER TIMING CONTROL B
+	0xED, 4, 0x64, 0x03, 0x12, 0x81,						//POWER ON SEQUENCE CONTROL
+	0xF7, 1, 0x20,											//PUMP RATIO CONTROL
+	0xC0, 1, 0x23,											//POWER CONTROL,VRH[5:0]
+	0xC1, 1, 0x10,											//POWER CONTROL,SAP[2:0];BT[3:0]
+	0xC5, 2, 0x3E, 0x28,									//VCM CONTROL
+	0xC7, 1, 0x86,											//VCM CONTROL 2
+	0x36, 1, 0x48,											//MEMORY ACCESS CONTROL
+	0x3A, 1, 0x55,											//PIXEL FORMAT
+	0xB1, 2, 0x00, 0x18,									//FRAME RATIO CONTROL, STANDARD RGB COLOR
+	0xB6, 3, 0x08, 0x82, 0x27,								//DISPLAY FUNCTION CONTROL
+	0xF2, 1, 0x00,											//3GAMMA FUNCTION DISABLE
+	0x26, 1, 0x01,											//GAMMA CURVE SELECTED
+	0xE0, 15, 0x0F, 0x31, 0x2B, 0x0C, 0x0E, 0x08, 0x4E, 0xF1,	//POSITIVE GAMMA CORRECTION
+			  0x37, 0x07, 0x10, 0x03, 0x0E, 0x09, 0x00,
+	0xE1, 15, 0x00, 0x0E, 0x14, 0x03, 0x11, 0x07, 0x31, 0xC1,	//NEGATIVE GAMMA CORRECTION
+			  0x48, 0x08, 0x0F, 0x0C, 0x31, 0x36, 0x0F,
+	0x11, ILI9341_INIT_DELAY, 0x00, 0x78,					//EXIT SLEEP, 120 ms
+	0x29, 0,												//TURN ON DISPLAY
+	ILI9341_INIT_END
+};
+
+/**
+ * @brief  Returns the Cortex-M4 cycle counter, starting it on first use.
+ * @retval DWT CYCCNT, wraps every 2^32 cycles (25 s at 168 MHz).
+ *
+ * Shared by the init timing, ILI9341_Bench and ILI9341_Profile.
+ */
+uint32_t ILI9341_Cycles(void)
+{
+	if(!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk))
+	{
+		CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+		DWT->CYCCNT = 0;
+		DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	}
+	return DWT->CYCCNT;
+}
+
+/**
+ * @brief  Converts a cycle count interval to microseconds.
+ */
+static uint32_t ILI9341_Cycles_To_us(uint32_t Cycles)
+{
+	return Cycles / (SystemCoreClock / 1000000);
+}
+
+/**
+ * @brief  Sends init table entries until one that needs a delay.
+ * @retval 1 when the end of the table was reached, 0 when a wait was started.
+ */
+static uint8_t ILI9341_Init_Table_Step(void)
+{
+	while(*init_table != ILI9341_INIT_END)
+	{
+		uint8_t command = *init_table++;
+		uint8_t length = *init_table++;
+		uint8_t count = length & ~ILI9341_INIT_DELAY;
+
+		ILI9341_Write_Command_Params(command, init_table, count);
+		init_table += count;
+
+		if(length & ILI9341_INIT_DELAY)
+		{
+			init_command = command;
+			init_delay = (init_table[0] << 8) | init_table[1];
+			init_table += 2;
+			init_wait_start = HAL_GetTick();
+			init_wait_cycles = ILI9341_Cycles();
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ * @brief  Checks whether the delay after an init table command is over.
+ * @retval 1 when the next command may be sent.
+ * 
+ * With ILI9341_FAST_INIT the software reset and sleep out waits are cut to the
+ * datasheet minimum. Sleep out is then optionally confirmed by polling the
+ * display power mode (booster on and sleep out bits) once per tick, falling
+ * back to the table delay if the status never shows up (e.g. MISO not wired).
+ */
+static uint8_t ILI9341_Init_Wait_Done(void)
+{
+	uint32_t waited = HAL_GetTick() - init_wait_start;
+	uint16_t delay = init_delay;
+
+#if ILI9341_FAST_INIT
+	if(init_command == 0x01)
+	{
+		delay = ILI9341_SWRESET_MIN_MS;
+	}
+	else if(init_command == 0x11)
+	{
+		if(waited <= ILI9341_SLPOUT_MIN_MS) return 0;
+#if ILI9341_INIT_POLL_STATUS
+		if((waited <= delay) && (waited != init_last_poll))
+		{
+			init_last_poll = waited;
+			boot_times.Status_Polls++;
+			if((ILI9341_Read_Register(0x0A) & 0x90) != 0x90) return 0;
+		}
+		else if(waited <= delay)
+		{
+			return 0;
+		}
+#endif
+		delay = 0;
+	}
+#endif
+	if(waited <= delay) return 0;
+
+	uint32_t elapsed = ILI9341_Cycles_To_us(ILI9341_Cycles() - init_wait_cycles);
+	if(init_command == 0x01)
+	{
+		boot_times.Software_Reset_us += elapsed;
+	}
+	else if(init_command == 0x11)
+	{
+		boot_times.Sleep_Out_us += elapsed;
+	}
+	return 1;
+}
+
+/**
+ * @brief  Runs a panel initialisation table.
+ * @param  Table: Pointer to the table, usually a const array in flash.
+ * @retval None
+ * 
+ * Each entry is the command byte, a length byte holding the number of
+ * parameters, the parameters themselves and, when ILI9341_INIT_DELAY is set in
+ * the length byte, a big-endian 16-bit delay in milliseconds. The table ends
+ * with ILI9341_INIT_END. Every command is sent with its parameters in a single
+ * transaction, so supporting another panel variant only needs another table.
+ * This call blocks through the delays; ILI9341_Init_Start runs the built-in
+ * table without blocking.
+ */
+void ILI9341_Run_Init_Table(const uint8_t* Table)
+{
+	ILI9341_PROFILE_FUNCTION(Run_Init_Table);
+	init_table = Table;
+	init_last_poll = 0xFFFFFFFF;
+	while(!ILI9341_Init_Table_Step())
+	{
+		while(!ILI9341_Init_Wait_Done())
+		{
+		}
+	}
+}
+
+/*Start LCD initialisation without blocking*/
+/**
+ * @brief  Starts the ILI9341 power-up sequence and returns immediately.
+ * 
+ * The hardware reset is asserted here; ILI9341_Init_Poll then releases it,
+ * runs ILI9341_Init_Sequence and sets the initial rotation, doing at most one
+ * step per call and never waiting inside HAL_Delay. The firmware can decompress
+ * assets, mount storage or pre-render while the panel comes up.
+ */
+void ILI9341_Init_Start(void)
+{
+	ILI9341_Boot_Times_TypeDef cleared = {0};
+	boot_times = cleared;
+	init_start_cycles = ILI9341_Cycles();
+
+	ILI9341_Enable();
+	ILI9341_SPI_init();
+	ILI9341_Invalidate_Window();
+
+	HAL_GPIO_WritePin(RESET_GPIO_Port, RESET_Pin, GPIO_PIN_RESET);
+	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
+	init_wait_start = HAL_GetTick();
+	init_state = ILI9341_INIT_RESET_PULSE;
+}
+
+/*Advance LCD initialisation*/
+/**
+ * @brief  Advances the power-up sequence started by ILI9341_Init_Start.
+ * @retval ILI9341_INIT_READY once the display is on and may be drawn to,
+ *         ILI9341_INIT_BUSY otherwise.
+ * 
+ * Call it regularly from the main loop (or from a periodic timer callback, as
+ * long as nothing else uses the display meanwhile). Waits are measured with
+ * HAL_GetTick, so each call only compares the tick unless a command is due.
+ */
+uint8_t ILI9341_Init_Poll(void)
+{
+	ILI9341_PROFILE_FUNCTION(Init_Poll);
+	switch(init_state)
+	{
+		case ILI9341_INIT_RESET_PULSE:
+			if((HAL_GetTick() - init_wait_start) <= ILI9341_RESET_PULSE_MS) break;
+			HAL_GPIO_WritePin(RESET_GPIO_Port, RESET_Pin, GPIO_PIN_SET);
+			init_wait_start = HAL_GetTick();
+			init_state = ILI9341_INIT_RESET_RECOVERY;
+			break;
+
+		case ILI9341_INIT_RESET_RECOVERY:
+			if((HAL_GetTick() - init_wait_start) <= ILI9341_RESET_RECOVERY_MS) break;
+			boot_times.Reset_us = ILI9341_Cycles_To_us(ILI9341_Cycles() - init_start_cycles);
+			init_table = ILI9341_Init_Sequence;
+			init_last_poll = 0xFFFFFFFF;
+			init_state = ILI9341_INIT_TABLE;
+			break;
+
+		case ILI9341_INIT_TABLE:
+			if(!ILI9341_Init_Table_Step())
+			{
+				init_state = ILI9341_INIT_WAIT;
+				break;
+			}
+
+			//STARTING ROTATION
+			ILI9341_Set_Rotation(SCREEN_VERTICAL_1);
+
+			boot_times.Total_us = ILI9341_Cycles_To_us(ILI9341_Cycles() - init_start_cycles);
+			boot_times.Configure_us = boot_times.Total_us - boot_times.Reset_us
+									- boot_times.Software_Reset_us - boot_times.Sleep_Out_us;
+			init_state = ILI9341_INIT_DONE;
+			break;
+
+		case ILI9341_INIT_WAIT:
+			if(ILI9341_Init_Wait_Done())
+			{
+				init_state = ILI9341_INIT_TABLE;
+			}
+			break;
+
+		default:
+			break;
+	}
+	return (init_state == ILI9341_INIT_DONE) ? ILI9341_INIT_READY : ILI9341_INIT_BUSY;
+}
+
 /*Initialize LCD display*/
 /**
  * @brief  Initializes the ILI9341 LCD display.
  * 
  * This function performs the necessary initialization sequence for the ILI9341
  * LCD display, including enabling the display, initializing the SPI interface,
- * resetting the display, and configuring various control registers.
- * 
- * The initialization sequence includes:
+ * resetting the display, and running ILI9341_Init_Sequence, which covers:
  * - Software reset
  * - Power control settings
  * - Driver timing control settings
@@ -199,147 +1149,30 @@ HAL_GPIO_WritePin(RESET_GPIO_Port, RESET_Pin, GPIO_PIN_SET);
  * - Gamma correction settings
  * - Exiting sleep mode
  * - Turning on the display
- * - Setting the initial rotation
+ * Finally the initial rotation is set. The time spent in each phase is
+ * recorded, see ILI9341_Get_Boot_Times.
+ * 
+ * This is the blocking form of ILI9341_Init_Start/ILI9341_Init_Poll.
  * 
  * @note This function assumes that the necessary hardware setup (e.g., GPIO, SPI)
  *       has already been performed.
  */
 void ILI9341_Init(void)
 {
-	ILI9341_Enable();
-	ILI9341_SPI_init();
+	ILI9341_PROFILE_FUNCTION(Init);
+	ILI9341_Init_Start();
+	while(ILI9341_Init_Poll() != ILI9341_INIT_READY)
+	{
+	}
+}
 
-	ILI9341_Reset();
-
-	//SOFTWARE RESET
-	ILI9341_Write_Command(0x01);
-	HAL_Delay(1000);
-
-	//POWER CONTROL A
-	ILI9341_Write_Command(0xCB);
-	ILI9341_Write_Data(0x39);
-	ILI9341_Write_Data(0x2C);
-	ILI9341_Write_Data(0x00);
-	ILI9341_Write_Data(0x34);
-	ILI9341_Write_Data(0x02);
-
-	//POWER CONTROL B
-	ILI9341_Write_Command(0xCF);
-	ILI9341_Write_Data(0x00);
-	ILI9341_Write_Data(0xC1);
-	ILI9341_Write_Data(0x30);
-
-	//DRIVER TIMING CONTROL A
-	ILI9341_Write_Command(0xE8);
-	ILI9341_Write_Data(0x85);
-	ILI9341_Write_Data(0x00);
-	ILI9341_Write_Data(0x78);
-
-	//DRIVER TIMING CONTROL B
-	ILI9341_Write_Command(0xEA);
-	ILI9341_Write_Data(0x00);
-	ILI9341_Write_Data(0x00);
-
-	//POWER ON SEQUENCE CONTROL
-	ILI9341_Write_Command(0xED);
-	ILI9341_Write_Data(0x64);
-	ILI9341_Write_Data(0x03);
-	ILI9341_Write_Data(0x12);
-	ILI9341_Write_Data(0x81);
-
-	//PUMP RATIO CONTROL
-	ILI9341_Write_Command(0xF7);
-	ILI9341_Write_Data(0x20);
-
-	//POWER CONTROL,VRH[5:0]
-	ILI9341_Write_Command(0xC0);
-	ILI9341_Write_Data(0x23);
-
-	//POWER CONTROL,SAP[2:0];BT[3:0]
-	ILI9341_Write_Command(0xC1);
-	ILI9341_Write_Data(0x10);
-
-	//VCM CONTROL
-	ILI9341_Write_Command(0xC5);
-	ILI9341_Write_Data(0x3E);
-	ILI9341_Write_Data(0x28);
-
-	//VCM CONTROL 2
-	ILI9341_Write_Command(0xC7);
-	ILI9341_Write_Data(0x86);
-
-	//MEMORY ACCESS CONTROL
-	ILI9341_Write_Command(0x36);
-	ILI9341_Write_Data(0x48);
-
-	//PIXEL FORMAT
-	ILI9341_Write_Command(0x3A);
-	ILI9341_Write_Data(0x55);
-
-	//FRAME RATIO CONTROL, STANDARD RGB COLOR
-	ILI9341_Write_Command(0xB1);
-	ILI9341_Write_Data(0x00);
-	ILI9341_Write_Data(0x18);
-
-	//DISPLAY FUNCTION CONTROL
-	ILI9341_Write_Command(0xB6);
-	ILI9341_Write_Data(0x08);
-	ILI9341_Write_Data(0x82);
-	ILI9341_Write_Data(0x27);
-
-	//3GAMMA FUNCTION DISABLE
-	ILI9341_Write_Command(0xF2);
-	ILI9341_Write_Data(0x00);
-
-	//GAMMA CURVE SELECTED
-	ILI9341_Write_Command(0x26);
-	ILI9341_Write_Data(0x01);
-
-	//POSITIVE GAMMA CORRECTION
-	ILI9341_Write_Command(0xE0);
-	ILI9341_Write_Data(0x0F);
-	ILI9341_Write_Data(0x31);
-	ILI9341_Write_Data(0x2B);
-	ILI9341_Write_Data(0x0C);
-	ILI9341_Write_Data(0x0E);
-	ILI9341_Write_Data(0x08);
-	ILI9341_Write_Data(0x4E);
-	ILI9341_Write_Data(0xF1);
-	ILI9341_Write_Data(0x37);
-	ILI9341_Write_Data(0x07);
-	ILI9341_Write_Data(0x10);
-	ILI9341_Write_Data(0x03);
-	ILI9341_Write_Data(0x0E);
-	ILI9341_Write_Data(0x09);
-	ILI9341_Write_Data(0x00);
-
-	//NEGATIVE GAMMA CORRECTION
-	ILI9341_Write_Command(0xE1);
-	ILI9341_Write_Data(0x00);
-	ILI9341_Write_Data(0x0E);
-	ILI9341_Write_Data(0x14);
-	ILI9341_Write_Data(0x03);
-	ILI9341_Write_Data(0x11);
-	ILI9341_Write_Data(0x07);
-	ILI9341_Write_Data(0x31);
-	ILI9341_Write_Data(0xC1);
-	ILI9341_Write_Data(0x48);
-	ILI9341_Write_Data(0x08);
-	ILI9341_Write_Data(0x0F);
-	ILI9341_Write_Data(0x0C);
-	ILI9341_Write_Data(0x31);
-	ILI9341_Write_Data(0x36);
-	ILI9341_Write_Data(0x0F);
-
-	//EXIT SLEEP
-	ILI9341_Write_Command(0x11);
-	HAL_Delay(120);
-
-	//TURN ON DISPLAY
-	ILI9341_Write_Command(0x29);
-
-	//STARTING ROTATION
-	ILI9341_Set_Rotation(SCREEN_VERTICAL_1);
+/**
+ * @brief  Copies the time spent in each phase of the last ILI9341_Init.
+ * @param  Times: Destination for the phase durations.
+ */
+void ILI9341_Get_Boot_Times(ILI9341_Boot_Times_TypeDef* Times)
+{
+	*Times = boot_times;
 }
 
 //INTERNAL FUNCTION OF LIBRARY, USAGE NOT RECOMENDED, USE Draw_Pixel INSTEAD
@@ -357,12 +1190,23 @@ void ILI9341_Init(void)
  */
 void ILI9341_Draw_Colour(uint16_t Colour)
 {
+#if ILI9341_INDEXED
+	if(ILI9341_Get_Render_Mode() == ILI9341_RENDER_INDEXED)
+	{
+		ILI9341_Draw_Colour_Burst(Colour, 1);
+		return;
+	}
+#endif
 //SENDS COLOUR
 	unsigned char TempBuffer[2] = {Colour>>8, Colour};
+	ILI9341_Wait_Idle();
+	ILI9341_Bus_Mode(ILI9341_BUS_8BIT);
 	HAL_GPIO_WritePin(DC_GPIO_Port, DC_Pin, GPIO_PIN_SET);
 	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
+	traffic.Bytes += 2;
 	HAL_SPI_Transmit(&hspi2, TempBuffer, 2, 1);
-	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_SET);
+	ILI9341_CS_Release();
+	ILI9341_Advance_Write_Pointer(1);
 }
 
 
@@ -371,60 +1215,52 @@ void ILI9341_Draw_Colour(uint16_t Colour)
 /**
  * @brief Draws a burst of color on the ILI9341 display.
  *
- * This function sends a burst of color data to the ILI9341 display using SPI.
- * It divides the data into manageable chunks and transmits them in blocks.
- *
  * @param Colour The 16-bit color value to be sent.
  * @param Size The number of pixels to be colored.
  *
- * The function first determines the buffer size based on the given size and
- * the maximum burst size. It then prepares a buffer with the color data and
- * transmits it in blocks using the HAL SPI transmit function. Any remaining
- * data that does not fit into a full block is transmitted separately.
+ * No pixel buffer is used. The bus is switched to 16-bit frames and the DMA
+ * streams the single colour word with memory increment disabled, up to
+ * ILI9341_DMA_MAX_TRANSFER pixels per request. The call returns as soon as the
+ * transfer is started; the next call that needs the bus waits for it.
  *
- * The function uses GPIO pins to control the data/command mode and chip select
- * signals for the SPI communication.
+ * Bursts shorter than ILI9341_FILL_DMA_THRESHOLD pixels are sent with blocking
+ * transfers in the current bus mode, where the DMA setup would cost more than
+ * the pixels themselves.
  */
 void ILI9341_Draw_Colour_Burst(uint16_t Colour, uint32_t Size)
+{
+	ILI9341_PROFILE_FUNCTION(Draw_Colour_Burst);
+#if ILI9341_INDEXED
+	if(ILI9341_Get_Render_Mode() == ILI9341_RENDER_INDEXED)
 	{
-	//SENDS COLOUR
-	uint32_t Buffer_Size = 0;
-	if((Size*2) < BURST_MAX_SIZE)
-	{
-		Buffer_Size = Size;
-	}
-	else
-	{
-		Buffer_Size = BURST_MAX_SIZE;
+		ILI9341_Indexed_Fill_Window(Size, Colour);
+		return;
 	}
+#endif
+	//SENDS COLOUR
+	ILI9341_Wait_Idle();
+	if(Size == 0) return;
 
-	HAL_GPIO_WritePin(DC_GPIO_Port, DC_Pin, GPIO_PIN_SET);
-	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
-
-	unsigned char chifted = 	Colour>>8;;
-	unsigned char burst_buffer[Buffer_Size];
-	for(uint32_t j = 0; j < Buffer_Size; j+=2)
+	if(Size < ILI9341_FILL_DMA_THRESHOLD)
+	{
+		unsigned char TempBuffer[2] = {Colour>>8, Colour};
+		ILI9341_Bus_Mode(ILI9341_BUS_8BIT);
+		HAL_GPIO_WritePin(DC_GPIO_Port, DC_Pin, GPIO_PIN_SET);
+		HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
+		traffic.Bytes += Size * 2;
+		for(uint32_t j = 0; j < Size; j++)
 		{
-			burst_buffer[j] = 	chifted;
-			burst_buffer[j+1] = Colour;
+			HAL_SPI_Transmit(&hspi2, TempBuffer, 2, 1);
 		}
-
-	uint32_t Sending_Size = Size*2;
-	uint32_t Sending_in_Block = Sending_Size/Buffer_Size;
-	uint32_t Remainder_from_block = Sending_Size%Buffer_Size;
-
-	if(Sending_in_Block != 0)
-	{
-		for(uint32_t j = 0; j < (Sending_in_Block); j++)
-			{
-			HAL_SPI_Transmit(&hspi2, (unsigned char *)burst_buffer, Buffer_Size, 10);
-			}
+		ILI9341_CS_Release();
+		ILI9341_Advance_Write_Pointer(Size);
+		return;
 	}
 
-	//REMAINDER!
-	HAL_SPI_Transmit(&hspi2, (unsigned char *)burst_buffer, Remainder_from_block, 10);
-
-	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_SET);
+	ILI9341_Bus_Mode(ILI9341_BUS_16BIT_FILL);
+	ILI9341_Advance_Write_Pointer(Size);
+	fill_colour = Colour;
+	ILI9341_DMA_Start((const uint8_t*)&fill_colour, Size, ILI9341_DMA_MAX_TRANSFER, 0);
 }
 
 
@@ -440,7 +1276,15 @@ void ILI9341_Draw_Colour_Burst(uint16_t Colour, uint32_t Size)
 /*Sets address (entire screen) and Sends Height*Width ammount of colour information to LCD*/
 void ILI9341_Fill_Screen(uint16_t Colour)
 {
-	ILI9341_Set_Address(0,0,LCD_WIDTH,LCD_HEIGHT);
+	ILI9341_PROFILE_FUNCTION(Fill_Screen);
+#if ILI9341_INDEXED
+	if(ILI9341_Get_Render_Mode() == ILI9341_RENDER_INDEXED)
+	{
+		ILI9341_Indexed_Fill_Rect(0, 0, LCD_WIDTH, LCD_HEIGHT, Colour);
+		return;
+	}
+#endif
+	ILI9341_Set_Address(0,0,LCD_WIDTH-1,LCD_HEIGHT-1);
 	ILI9341_Draw_Colour_Burst(Colour, LCD_WIDTH*LCD_HEIGHT);
 }
 
@@ -468,53 +1312,107 @@ void ILI9341_Fill_Screen(uint16_t Colour)
  * 
  * The sequence of operations is as follows:
  * 1. Check if the coordinates are within bounds.
- * 2. Set the column address (X coordinate).
- * 3. Set the page address (Y coordinate).
- * 4. Write the pixel color data.
+ * 2. Set a 1x1 address window (only the axes that changed are sent).
+ * 3. Write the pixel color data.
  */
 void ILI9341_Draw_Pixel(uint16_t X,uint16_t Y,uint16_t Colour)
 {
+	ILI9341_PROFILE_FUNCTION(Draw_Pixel);
 	if((X >=LCD_WIDTH) || (Y >=LCD_HEIGHT)) return;	//OUT OF BOUNDS!
+#if ILI9341_INDEXED
+	if(ILI9341_Get_Render_Mode() == ILI9341_RENDER_INDEXED)
+	{
+		ILI9341_Indexed_Fill_Rect(X, Y, 1, 1, Colour);
+		return;
+	}
+#endif
 
 	//ADDRESS
-	HAL_GPIO_WritePin(DC_GPIO_Port, DC_Pin, GPIO_PIN_RESET);
-	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
-	ILI9341_SPI_SEND(0x2A);
-	HAL_GPIO_WritePin(DC_GPIO_Port, DC_Pin, GPIO_PIN_SET);
-	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_SET);
-
-	//XDATA
-	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
-	unsigned char Temp_Buffer[4] = {X>>8,X, (X+1)>>8, (X+1)};
-	HAL_SPI_Transmit(&hspi2, Temp_Buffer, 4, 1);
-	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_SET);
+	ILI9341_Set_Address(X, Y, X, Y);
 
-	//ADDRESS
-	HAL_GPIO_WritePin(DC_GPIO_Port, DC_Pin, GPIO_PIN_RESET);
-	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
-	ILI9341_SPI_SEND(0x2B);
-	HAL_GPIO_WritePin(DC_GPIO_Port, DC_Pin, GPIO_PIN_SET);
-	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_SET);
+	//COLOUR
+	ILI9341_Draw_Colour(Colour);
+}
 
-	//YDATA
-	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
-	unsigned char Temp_Buffer1[4] = {Y>>8,Y, (Y+1)>>8, (Y+1)};
-	HAL_SPI_Transmit(&hspi2, Temp_Buffer1, 4, 1);
-	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_SET);
+/**
+ * @brief  Sorts pixel keys in ascending order (shell sort, no recursion or heap).
+ * @param  Keys: Keys to sort.
+ * @param  Count: Number of keys.
+ */
+static ILI9341_RAMFUNC void ILI9341_Sort_Keys(uint32_t* Keys, uint32_t Count)
+{
+	for(uint32_t gap = Count / 2; gap > 0; gap /= 2)
+	{
+		for(uint32_t i = gap; i < Count; i++)
+		{
+			uint32_t key = Keys[i];
+			uint32_t j = i;
+			while((j >= gap) && (Keys[j - gap] > key))
+			{
+				Keys[j] = Keys[j - gap];
+				j -= gap;
+			}
+			Keys[j] = key;
+		}
+	}
+}
 
-	//ADDRESS
-	HAL_GPIO_WritePin(DC_GPIO_Port, DC_Pin, GPIO_PIN_RESET);
-	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
-	ILI9341_SPI_SEND(0x2C);
-	HAL_GPIO_WritePin(DC_GPIO_Port, DC_Pin, GPIO_PIN_SET);
-	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_SET);
+//DRAW A SET OF SCATTERED PIXELS WITH SELECTED COLOUR
+/**
+ * @brief  Draws many single pixels of the same colour in one transaction.
+ * @param  Points: Pixel coordinates, in any order; off-screen points are skipped.
+ * @param  Count: Number of points.
+ * @param  Colour: The color of the pixels in RGB565 format.
+ * @retval None
+ * 
+ * The points are processed in batches of ILI9341_PIXELS_BATCH. Each batch is
+ * clipped, sorted by row and column, and horizontally adjacent pixels are
+ * merged into runs, so every run costs one address window and one colour
+ * burst instead of a window and a colour per pixel. Duplicate points are
+ * drawn once. The whole call is a single CS assertion.
+ */
+ILI9341_RAMFUNC void ILI9341_Draw_Pixels(const ILI9341_Point_TypeDef* Points, uint32_t Count, uint16_t Colour)
+{
+	ILI9341_PROFILE_FUNCTION(Draw_Pixels);
+#if ILI9341_INDEXED
+	if(ILI9341_Get_Render_Mode() == ILI9341_RENDER_INDEXED)
+	{
+		ILI9341_Indexed_Draw_Pixels(Points, Count, Colour);
+		return;
+	}
+#endif
+	ILI9341_Begin_Write();
+	while(Count != 0)
+	{
+		uint32_t n = 0;
+		uint32_t batch = (Count < ILI9341_PIXELS_BATCH) ? Count : ILI9341_PIXELS_BATCH;
 
-	//COLOUR
-	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
-	unsigned char Temp_Buffer2[2] = {Colour>>8, Colour};
-	HAL_SPI_Transmit(&hspi2, Temp_Buffer2, 2, 1);
-	HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_SET);
+		for(uint32_t i = 0; i < batch; i++)
+		{
+			if((Points[i].X < LCD_WIDTH) && (Points[i].Y < LCD_HEIGHT))
+			{
+				pixel_keys[n++] = ((uint32_t)Points[i].Y << 16) | Points[i].X;
+			}
+		}
+		Points += batch;
+		Count -= batch;
+		ILI9341_Sort_Keys(pixel_keys, n);
 
+		uint32_t i = 0;
+		while(i < n)
+		{
+			uint32_t start = pixel_keys[i];
+			uint32_t end = start;
+			//extend the run over duplicates and the next column of the same row
+			while((++i < n) && ((pixel_keys[i] == end) || (pixel_keys[i] == end + 1)))
+			{
+				end = pixel_keys[i];
+			}
+			ILI9341_Set_Address(start & 0xFFFF, start >> 16, end & 0xFFFF, start >> 16);
+			ILI9341_Draw_Colour_Burst(Colour, end - start + 1);
+		}
+	}
+	ILI9341_End_Write();
 }
 
 
@@ -542,7 +1440,15 @@ void ILI9341_Draw_Pixel(uint16_t X,uint16_t Y,uint16_t Colour)
  */
 void ILI9341_Draw_Rectangle(uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height, uint16_t Colour)
 {
+	ILI9341_PROFILE_FUNCTION(Draw_Rectangle);
 	if((X >=LCD_WIDTH) || (Y >=LCD_HEIGHT)) return;
+#if ILI9341_INDEXED
+	if(ILI9341_Get_Render_Mode() == ILI9341_RENDER_INDEXED)
+	{
+		ILI9341_Indexed_Fill_Rect(X, Y, Width, Height, Colour);
+		return;
+	}
+#endif
 	if((X+Width-1)>=LCD_WIDTH)
 		{
 			Width=LCD_WIDTH-X;
@@ -575,7 +1481,15 @@ void ILI9341_Draw_Rectangle(uint16_t X, uint16_t Y, uint16_t Width, uint16_t Hei
 //DRAW LINE FROM X,Y LOCATION to X+Width,Y LOCATION
 void ILI9341_Draw_Horizontal_Line(uint16_t X, uint16_t Y, uint16_t Width, uint16_t Colour)
 {
+	ILI9341_PROFILE_FUNCTION(Draw_Horizontal_Line);
 	if((X >=LCD_WIDTH) || (Y >=LCD_HEIGHT)) return;
+#if ILI9341_INDEXED
+	if(ILI9341_Get_Render_Mode() == ILI9341_RENDER_INDEXED)
+	{
+		ILI9341_Indexed_Fill_Rect(X, Y, Width, 1, Colour);
+		return;
+	}
+#endif
 	if((X+Width-1)>=LCD_WIDTH)
 		{
 			Width=LCD_WIDTH-X;
@@ -596,7 +1510,15 @@ void ILI9341_Draw_Horizontal_Line(uint16_t X, uint16_t Y, uint16_t Width, uint16
  */
 void ILI9341_Draw_Vertical_Line(uint16_t X, uint16_t Y, uint16_t Height, uint16_t Colour)
 {
+	ILI9341_PROFILE_FUNCTION(Draw_Vertical_Line);
 	if((X >=LCD_WIDTH) || (Y >=LCD_HEIGHT)) return;
+#if ILI9341_INDEXED
+	if(ILI9341_Get_Render_Mode() == ILI9341_RENDER_INDEXED)
+	{
+		ILI9341_Indexed_Fill_Rect(X, Y, 1, Height, Colour);
+		return;
+	}
+#endif
 	if((Y+Height-1)>=LCD_HEIGHT)
 		{
 			Height=LCD_HEIGHT-Y;
@@ -9,6 +9,31 @@
 #define SRC_ILI9341_H_
 #include "main.h"
 extern SPI_HandleTypeDef hspi2;
+extern DMA_HandleTypeDef hdma_spi2_tx;
+extern volatile uint16_t LCD_HEIGHT;
+extern volatile uint16_t LCD_WIDTH;
+
+#ifndef ILI9341_FAST_INIT
+#define ILI9341_FAST_INIT			1		//use the datasheet minimum reset/sleep-out timings instead of the legacy delays
+#endif
+#ifndef ILI9341_INIT_POLL_STATUS
+#define ILI9341_INIT_POLL_STATUS	1		//fast init: confirm sleep-out by reading the power mode (0x0A) over MISO
+#endif
+#ifndef ILI9341_PROFILE
+#define ILI9341_PROFILE				0		//time every driver entry point with the DWT cycle counter, see ILI9341_Profile.h
+#endif
+#ifndef ILI9341_INDEXED
+#define ILI9341_INDEXED				0		//76.8 KB 8bpp framebuffer render mode, see ILI9341_Indexed.h
+#endif
+#if ILI9341_FAST_INIT
+#define ILI9341_RESET_PULSE_MS		1		//datasheet: reset low at least 10 us
+#define ILI9341_RESET_RECOVERY_MS	5		//datasheet: 5 ms after reset release before commands
+#else
+#define ILI9341_RESET_PULSE_MS		400
+#define ILI9341_RESET_RECOVERY_MS	0
+#endif
+#define ILI9341_SWRESET_MIN_MS		5		//datasheet: 5 ms after software reset before the next command
+#define ILI9341_SLPOUT_MIN_MS		5		//datasheet: 5 ms after sleep out before the next command
 
 #define SCREEN_VERTICAL_1			0
 #define SCREEN_HORIZONTAL_1		1
@@ -16,8 +41,66 @@ extern SPI_HandleTypeDef hspi2;
 #define SCREEN_HORIZONTAL_2		3
 #define ILI9341_SCREEN_HEIGHT 240
 #define ILI9341_SCREEN_WIDTH 	320
-#define BURST_MAX_SIZE 	500
+#define ILI9341_DMA_BUFFER_SIZE		1280	//bytes per transfer buffer (two 320 pixel lines)
+#ifndef ILI9341_TRANSFER_BUFFERS
+#define ILI9341_TRANSFER_BUFFERS	2		//transfer buffers in the pool, more to keep some resident
+#endif
+#define ILI9341_DMA_MAX_TRANSFER	65535	//largest single HAL_SPI_Transmit_DMA request (frames)
+#define ILI9341_FILL_DMA_THRESHOLD	32		//fills below this many pixels are sent without DMA
+#define ILI9341_PIXELS_BATCH		128		//points sorted and merged at a time by ILI9341_Draw_Pixels
+
+#define ILI9341_INIT_DELAY			0x80	//init table: length byte flag, a 16-bit delay in ms follows the parameters
+#define ILI9341_INIT_END			0x00	//init table: terminator in place of a command byte
+
+#define ILI9341_INIT_BUSY			0		//ILI9341_Init_Poll: power-up sequence still running
+#define ILI9341_INIT_READY			1		//ILI9341_Init_Poll: display on, drawing allowed
+
+#define ILI9341_BUS_8BIT			0		//8-bit frames, DMA memory increment on (commands, pixel streams)
+#define ILI9341_BUS_16BIT_FILL		1		//16-bit frames, DMA memory increment off (constant colour fills)
+
+#define ILI9341_BUFFER_KEEP			0		//ILI9341_Send_Buffer: the caller keeps the buffer to send it again
+#define ILI9341_BUFFER_RELEASE		1		//ILI9341_Send_Buffer: the buffer returns to the pool when sent
+
 
+typedef struct
+{
+	uint16_t X;
+	uint16_t Y;
+} ILI9341_Point_TypeDef;
+
+typedef struct
+{
+	uint32_t Windows;			//ILI9341_Set_Address calls
+	uint32_t Column_Skipped;	//CASET (0x2A) commands not re-sent
+	uint32_t Page_Skipped;		//PASET (0x2B) commands not re-sent
+	uint32_t Write_Skipped;		//RAMWR (0x2C) commands not re-sent
+	uint32_t Bytes_Saved;		//command and parameter bytes kept off the bus
+} ILI9341_Window_Stats_TypeDef;
+
+typedef struct
+{
+	uint32_t Bytes;				//bytes clocked out on SPI2, commands included
+	uint32_t Pixels;			//pixels written into display RAM
+} ILI9341_Traffic_TypeDef;
+
+typedef struct
+{
+	uint32_t Buffers;			//ILI9341_TRANSFER_BUFFERS
+	uint32_t In_Use;			//buffers acquired or on the bus now
+	uint32_t Peak;				//most buffers in use at once since start-up
+	uint32_t Waits;				//acquires that waited for a transfer to finish
+	uint32_t Failures;			//acquires refused, every buffer held by the caller
+} ILI9341_Transfer_Stats_TypeDef;
+
+typedef struct
+{
+	uint32_t Reset_us;				//hardware reset pulse and recovery
+	uint32_t Software_Reset_us;		//wait after software reset (0x01)
+	uint32_t Configure_us;			//register set-up commands
+	uint32_t Sleep_Out_us;			//wait after sleep out (0x11), including status polls
+	uint32_t Total_us;				//whole ILI9341_Init
+	uint32_t Status_Polls;			//power mode reads issued while waiting for sleep out
+} ILI9341_Boot_Times_TypeDef;
 
 #define BLACK       0x0000
 #define NAVY        0x000F
@@ -42,19 +125,47 @@ extern SPI_HandleTypeDef hspi2;
 
 void ILI9341_SPI_init(void);
 void ILI9341_SPI_SEND(unsigned char SPI_Data);
+void ILI9341_Bus_Mode(uint8_t Mode);
 void ILI9341_Write_Command(uint8_t Command);
+void ILI9341_Write_Command_Params(uint8_t Command, const uint8_t* Params, uint16_t Length);
 void ILI9341_Write_Data(uint8_t Data);
+uint8_t ILI9341_Read_Register(uint8_t Command);
 void ILI9341_Set_Address(uint16_t X1, uint16_t Y1, uint16_t X2, uint16_t Y2);
+void ILI9341_Set_Panel_Address(uint16_t X1, uint16_t Y1, uint16_t X2, uint16_t Y2);
+void ILI9341_Invalidate_Window(void);
+void ILI9341_Get_Window_Stats(ILI9341_Window_Stats_TypeDef* Stats);
+void ILI9341_Reset_Window_Stats(void);
 void ILI9341_Reset(void);
 void ILI9341_Set_Rotation(uint8_t Rotation);
 void ILI9341_Enable(void);
+void ILI9341_Run_Init_Table(const uint8_t* Table);
+void ILI9341_Init_Start(void);
+uint8_t ILI9341_Init_Poll(void);
 void ILI9341_Init(void);
+void ILI9341_Get_Boot_Times(ILI9341_Boot_Times_TypeDef* Times);
+uint32_t ILI9341_Cycles(void);
 void ILI9341_Draw_Colour(uint16_t Colour);
 void ILI9341_Draw_Colour_Burst(uint16_t Colour, uint32_t Size);
 void ILI9341_Fill_Screen(uint16_t Colour);
 void ILI9341_Draw_Pixel(uint16_t X,uint16_t Y,uint16_t Colour);
+void ILI9341_Draw_Pixels(const ILI9341_Point_TypeDef* Points, uint32_t Count, uint16_t Colour);
 void ILI9341_Draw_Rectangle(uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height, uint16_t Colour);
 void ILI9341_Draw_Horizontal_Line(uint16_t X, uint16_t Y, uint16_t Width, uint16_t Colour);
 void ILI9341_Draw_Vertical_Line(uint16_t X, uint16_t Y, uint16_t Height, uint16_t Colour);
 
+uint8_t ILI9341_Is_Busy(void);
+void ILI9341_Wait_Idle(void);
+void ILI9341_Get_Traffic(ILI9341_Traffic_TypeDef* Traffic);
+void ILI9341_Begin_Write(void);
+void ILI9341_End_Write(void);
+void ILI9341_Transmit_DMA(const uint8_t* Data, uint32_t Size);
+void ILI9341_Transmit_DMA_Rows(const uint8_t* Data, uint32_t Row_Size, uint32_t Rows, uint32_t Stride);
+void ILI9341_Transfer_Complete_Callback(void);
+uint8_t* ILI9341_Get_Back_Buffer(void);
+void ILI9341_Send_Back_Buffer(uint32_t Size);
+uint8_t* ILI9341_Acquire_Buffer(void);
+void ILI9341_Send_Buffer(uint8_t* Buffer, uint32_t Size, uint8_t Release);
+void ILI9341_Release_Buffer(uint8_t* Buffer);
+void ILI9341_Get_Transfer_Stats(ILI9341_Transfer_Stats_TypeDef* Stats);
+
 #endif /* SRC_ILI9341_H_ */
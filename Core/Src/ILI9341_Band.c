@@ -0,0 +1,594 @@
+/*
+ * ILI9341_Band.c
+ *
+ *  Created on: Nov 27, 2024
+ *      Author: ellis
+ *
+ *  Band renderer. A 320x240 RGB565 frame (150 KB) does not fit in SRAM, so a
+ *  frame is recorded as a display list and rasterised band by band into two
+ *  buffers of ILI9341_BAND_LINES rows:
+ *
+ *    ILI9341_Band_Begin(WHITE);
+ *    ILI9341_Band_Invalidate(...);      areas that changed since the last frame
+ *    ILI9341_Band_Fill_Rect(...);       the scene, back to front
+ *    ILI9341_Band_Text(...);
+ *    ILI9341_Band_End();                rasterise and send the dirty areas
+ *
+ *  Only dirty areas are sent: for each band the dirty rectangles crossing it
+ *  are joined into one address window, the window is cleared to the
+ *  background colour, every command touching it is drawn in order and the
+ *  result goes out by DMA while the next band is rendered into the other
+ *  buffer. Overlapping commands therefore cost CPU time, not bus time, and
+ *  the panel never shows a half-drawn area.
+ *
+ *  A dirty area is repainted from the display list alone, so the list must
+ *  describe everything visible inside it (submit the whole scene each frame;
+ *  commands outside the dirty areas cost only list space). The output is
+ *  pixel-identical to the ILI9341_Draw_xxx calls with the same arguments.
+ */
+
+#include <string.h>
+#include "ILI9341_Band.h"
+#include "ILI9341_Profile.h"
+#include "ILI9341_Memory.h"
+#include "5x5_font.h"
+
+#define ILI9341_BAND_RECT			0
+#define ILI9341_BAND_HOLLOW_CIRCLE	1
+#define ILI9341_BAND_FILLED_CIRCLE	2
+#define ILI9341_BAND_TEXT			3
+#define ILI9341_BAND_BITMAP			4
+
+typedef struct
+{
+	int16_t		X0, Y0, X1, Y1;		//inclusive, on screen
+} ILI9341_Band_Rect_TypeDef;
+
+typedef struct
+{
+	uint8_t			Type;			//ILI9341_BAND_xxx
+	ILI9341_Band_Rect_TypeDef Bounds;	//screen area the command can touch, unclipped
+	int16_t			X, Y;			//origin: top-left corner, or circle centre
+	uint16_t		Colour;			//display byte order
+	uint16_t		Background;		//text background, display byte order
+	uint16_t		Size;			//text size, circle radius
+	uint16_t		Length;			//text characters, bitmap source stride in pixels
+	const void*		Data;			//text in the pool, bitmap source
+} ILI9341_Band_Command_TypeDef;
+
+static uint16_t band_buffer[2][ILI9341_BAND_LINES*ILI9341_SCREEN_WIDTH] ILI9341_DMA_RAM;
+static ILI9341_Band_Command_TypeDef band_commands[ILI9341_BAND_MAX_COMMANDS] ILI9341_CCMRAM;
+static uint16_t band_command_count;
+static char band_text[ILI9341_BAND_TEXT_POOL] ILI9341_CCMRAM;
+static uint16_t band_text_used;
+static ILI9341_Band_Rect_TypeDef band_dirty[ILI9341_BAND_MAX_DIRTY] ILI9341_CCMRAM;
+static uint8_t band_dirty_count;
+static uint16_t band_background;
+static ILI9341_Band_Stats_TypeDef band_stats;
+
+/*Window being rendered: screen area and the buffer that holds it*/
+static uint16_t* clip_buffer;
+static int clip_x0, clip_y0, clip_x1, clip_y1;
+static int clip_width;
+
+/**
+ * @brief  RGB565 to display byte order, so a half-word store gives high byte first.
+ */
+static uint16_t ILI9341_Band_Swap(uint16_t Colour)
+{
+	return (Colour >> 8) | (Colour << 8);
+}
+
+/**
+ * @brief  Appends a command to the display list.
+ * @retval The new command, NULL when the list is full.
+ */
+static ILI9341_Band_Command_TypeDef* ILI9341_Band_Add(uint8_t Type, int X0, int Y0, int X1, int Y1)
+{
+	ILI9341_Band_Command_TypeDef* command;
+
+	if(band_command_count == ILI9341_BAND_MAX_COMMANDS)
+	{
+		band_stats.Dropped++;
+		return NULL;
+	}
+	command = &band_commands[band_command_count++];
+	command->Type = Type;
+	command->Bounds.X0 = (X0 < -32768) ? -32768 : X0;
+	command->Bounds.Y0 = (Y0 < -32768) ? -32768 : Y0;
+	command->Bounds.X1 = (X1 > 32767) ? 32767 : X1;
+	command->Bounds.Y1 = (Y1 > 32767) ? 32767 : Y1;
+	band_stats.Commands++;
+	return command;
+}
+
+/* Dirty rectangles */
+/**
+ * @brief  Starts a frame: empties the display list and the dirty area.
+ * @param  Background_Colour: Colour of dirty pixels no command draws on.
+ * @retval None
+ */
+void ILI9341_Band_Begin(uint16_t Background_Colour)
+{
+	ILI9341_PROFILE_FUNCTION(Band_Begin);
+	band_background = ILI9341_Band_Swap(Background_Colour);
+	band_command_count = 0;
+	band_text_used = 0;
+	band_dirty_count = 0;
+	memset(&band_stats, 0, sizeof(band_stats));
+}
+
+/**
+ * @brief  Marks a screen area to be repainted by ILI9341_Band_End.
+ * @param  X: Left edge, may be off screen.
+ * @param  Y: Top edge, may be off screen.
+ * @param  Width: Width of the area.
+ * @param  Height: Height of the area.
+ * @retval None
+ *
+ * The area is clipped to the screen and joined with every dirty rectangle it
+ * overlaps or touches. When ILI9341_BAND_MAX_DIRTY rectangles are in use, it
+ * is merged with the one whose bounding box grows the least.
+ */
+void ILI9341_Band_Invalidate(int16_t X, int16_t Y, uint16_t Width, uint16_t Height)
+{
+	ILI9341_PROFILE_FUNCTION(Band_Invalidate);
+	int x0 = (X < 0) ? 0 : X;
+	int y0 = (Y < 0) ? 0 : Y;
+	int x1 = (int)X + Width - 1;
+	int y1 = (int)Y + Height - 1;
+
+	if(x1 >= LCD_WIDTH) x1 = LCD_WIDTH - 1;
+	if(y1 >= LCD_HEIGHT) y1 = LCD_HEIGHT - 1;
+	if((x0 > x1) || (y0 > y1)) return;
+
+	for(;;)
+	{
+		uint8_t i;
+		uint8_t best = 0;
+		uint32_t best_growth = UINT32_MAX;
+
+		for(i = 0; i < band_dirty_count; i++)
+		{
+			const ILI9341_Band_Rect_TypeDef* dirty = &band_dirty[i];
+			if((dirty->X0 <= x1 + 1) && (x0 <= dirty->X1 + 1) && (dirty->Y0 <= y1 + 1) && (y0 <= dirty->Y1 + 1)) break;
+		}
+		if((i == band_dirty_count) && (band_dirty_count < ILI9341_BAND_MAX_DIRTY)) break;
+
+		if(i == band_dirty_count)
+		{
+			//no neighbour and no room: merge with the cheapest one
+			for(i = 0; i < band_dirty_count; i++)
+			{
+				const ILI9341_Band_Rect_TypeDef* dirty = &band_dirty[i];
+				int ux0 = (dirty->X0 < x0) ? dirty->X0 : x0;
+				int uy0 = (dirty->Y0 < y0) ? dirty->Y0 : y0;
+				int ux1 = (dirty->X1 > x1) ? dirty->X1 : x1;
+				int uy1 = (dirty->Y1 > y1) ? dirty->Y1 : y1;
+				uint32_t growth = (uint32_t)(ux1 - ux0 + 1)*(uy1 - uy0 + 1)
+								- (uint32_t)(dirty->X1 - dirty->X0 + 1)*(dirty->Y1 - dirty->Y0 + 1);
+				if(growth < best_growth)
+				{
+					best_growth = growth;
+					best = i;
+				}
+			}
+			i = best;
+		}
+
+		//take rectangle i into the new one and look again, the union may reach others
+		if(band_dirty[i].X0 < x0) x0 = band_dirty[i].X0;
+		if(band_dirty[i].Y0 < y0) y0 = band_dirty[i].Y0;
+		if(band_dirty[i].X1 > x1) x1 = band_dirty[i].X1;
+		if(band_dirty[i].Y1 > y1) y1 = band_dirty[i].Y1;
+		band_dirty[i] = band_dirty[--band_dirty_count];
+	}
+
+	band_dirty[band_dirty_count].X0 = x0;
+	band_dirty[band_dirty_count].Y0 = y0;
+	band_dirty[band_dirty_count].X1 = x1;
+	band_dirty[band_dirty_count].Y1 = y1;
+	band_dirty_count++;
+}
+
+/**
+ * @brief  Marks the whole screen dirty (first frame, rotation change).
+ * @retval None
+ */
+void ILI9341_Band_Invalidate_All(void)
+{
+	ILI9341_PROFILE_FUNCTION(Band_Invalidate_All);
+	ILI9341_Band_Invalidate(0, 0, LCD_WIDTH, LCD_HEIGHT);
+}
+
+/* Recording */
+/**
+ * @brief  Records a filled rectangle (also lines and pixels).
+ * @param  X: Left edge, may be off screen.
+ * @param  Y: Top edge, may be off screen.
+ * @param  Width: Width in pixels.
+ * @param  Height: Height in pixels.
+ * @param  Colour: Fill colour.
+ * @retval None
+ */
+void ILI9341_Band_Fill_Rect(int16_t X, int16_t Y, uint16_t Width, uint16_t Height, uint16_t Colour)
+{
+	ILI9341_PROFILE_FUNCTION(Band_Fill_Rect);
+	ILI9341_Band_Command_TypeDef* command;
+
+	if((Width == 0) || (Height == 0)) return;
+	command = ILI9341_Band_Add(ILI9341_BAND_RECT, X, Y, (int)X + Width - 1, (int)Y + Height - 1);
+	if(command == NULL) return;
+	command->Colour = ILI9341_Band_Swap(Colour);
+}
+
+/**
+ * @brief  Records a single pixel.
+ */
+void ILI9341_Band_Pixel(int16_t X, int16_t Y, uint16_t Colour)
+{
+	ILI9341_PROFILE_FUNCTION(Band_Pixel);
+	ILI9341_Band_Fill_Rect(X, Y, 1, 1, Colour);
+}
+
+/**
+ * @brief  Records a circle outline, same pixels as ILI9341_Draw_Hollow_Circle.
+ * @param  X: Centre X, may be off screen.
+ * @param  Y: Centre Y, may be off screen.
+ * @param  Radius: Radius in pixels.
+ * @param  Colour: Outline colour.
+ * @retval None
+ */
+void ILI9341_Band_Hollow_Circle(int16_t X, int16_t Y, uint16_t Radius, uint16_t Colour)
+{
+	ILI9341_PROFILE_FUNCTION(Band_Hollow_Circle);
+	ILI9341_Band_Command_TypeDef* command;
+
+	command = ILI9341_Band_Add(ILI9341_BAND_HOLLOW_CIRCLE, X - Radius, Y - Radius, X + Radius, Y + Radius);
+	if(command == NULL) return;
+	command->X = X;
+	command->Y = Y;
+	command->Size = Radius;
+	command->Colour = ILI9341_Band_Swap(Colour);
+}
+
+/**
+ * @brief  Records a filled circle, same pixels as ILI9341_Draw_Filled_Circle.
+ * @param  X: Centre X, may be off screen.
+ * @param  Y: Centre Y, may be off screen.
+ * @param  Radius: Radius in pixels.
+ * @param  Colour: Fill colour.
+ * @retval None
+ */
+void ILI9341_Band_Filled_Circle(int16_t X, int16_t Y, uint16_t Radius, uint16_t Colour)
+{
+	ILI9341_PROFILE_FUNCTION(Band_Filled_Circle);
+	ILI9341_Band_Command_TypeDef* command;
+
+	command = ILI9341_Band_Add(ILI9341_BAND_FILLED_CIRCLE, X - Radius, Y - Radius, X + Radius, Y + Radius);
+	if(command == NULL) return;
+	command->X = X;
+	command->Y = Y;
+	command->Size = Radius;
+	command->Colour = ILI9341_Band_Swap(Colour);
+}
+
+/**
+ * @brief  Records a text box, same pixels as ILI9341_Draw_Text.
+ * @param  Text: Null-terminated string, copied into the frame's text pool.
+ * @param  X: Left edge, may be off screen.
+ * @param  Y: Top edge, may be off screen.
+ * @param  Colour: Glyph colour.
+ * @param  Size: Scale factor.
+ * @param  Background_Colour: Colour of the rest of the text box.
+ * @retval None
+ */
+void ILI9341_Band_Text(const char* Text, int16_t X, int16_t Y, uint16_t Colour, uint16_t Size, uint16_t Background_Colour)
+{
+	ILI9341_PROFILE_FUNCTION(Band_Text);
+	ILI9341_Band_Command_TypeDef* command;
+	uint32_t length = strlen(Text);
+
+	if((length == 0) || (Size == 0)) return;
+	if(band_text_used + length > ILI9341_BAND_TEXT_POOL)
+	{
+		band_stats.Dropped++;
+		return;
+	}
+	command = ILI9341_Band_Add(ILI9341_BAND_TEXT, X, Y, X + (int)(length*CHAR_WIDTH*Size) - 1, Y + CHAR_HEIGHT*Size - 1);
+	if(command == NULL) return;
+	memcpy(&band_text[band_text_used], Text, length);
+	command->Data = &band_text[band_text_used];
+	band_text_used += length;
+	command->X = X;
+	command->Y = Y;
+	command->Length = length;
+	command->Size = Size;
+	command->Colour = ILI9341_Band_Swap(Colour);
+	command->Background = ILI9341_Band_Swap(Background_Colour);
+}
+
+/**
+ * @brief  Records a bitmap, or a sub-rectangle of a larger image.
+ * @param  X: Left edge, may be off screen.
+ * @param  Y: Top edge, may be off screen.
+ * @param  Width: Width in pixels.
+ * @param  Height: Height in pixels.
+ * @param  Source: First pixel, RGB565 high byte first. Not copied, must stay valid until ILI9341_Band_End.
+ * @param  Stride: Width of the source image in pixels.
+ * @retval None
+ */
+void ILI9341_Band_Bitmap(int16_t X, int16_t Y, uint16_t Width, uint16_t Height, const uint8_t* Source, uint16_t Stride)
+{
+	ILI9341_PROFILE_FUNCTION(Band_Bitmap);
+	ILI9341_Band_Command_TypeDef* command;
+
+	if((Width == 0) || (Height == 0)) return;
+	command = ILI9341_Band_Add(ILI9341_BAND_BITMAP, X, Y, (int)X + Width - 1, (int)Y + Height - 1);
+	if(command == NULL) return;
+	command->X = X;
+	command->Y = Y;
+	command->Length = Stride;
+	command->Data = Source;
+}
+
+/* Rasterisers, all clipped to the window being rendered */
+static ILI9341_RAMFUNC void ILI9341_Band_Fill(int X0, int Y0, int X1, int Y1, uint16_t Colour)
+{
+	if(X0 < clip_x0) X0 = clip_x0;
+	if(Y0 < clip_y0) Y0 = clip_y0;
+	if(X1 > clip_x1) X1 = clip_x1;
+	if(Y1 > clip_y1) Y1 = clip_y1;
+	if((X0 > X1) || (Y0 > Y1)) return;
+
+	band_stats.Pixels_Rendered += (uint32_t)(X1 - X0 + 1)*(Y1 - Y0 + 1);
+	for(int y = Y0; y <= Y1; y++)
+	{
+		uint16_t* pixel = clip_buffer + (y - clip_y0)*clip_width + (X0 - clip_x0);
+		for(int x = X0; x <= X1; x++)
+		{
+			*pixel++ = Colour;
+		}
+	}
+}
+
+static void ILI9341_Band_Plot(int X, int Y, uint16_t Colour)
+{
+	if((X < clip_x0) || (X > clip_x1) || (Y < clip_y0) || (Y > clip_y1)) return;
+	clip_buffer[(Y - clip_y0)*clip_width + (X - clip_x0)] = Colour;
+	band_stats.Pixels_Rendered++;
+}
+
+/*Same walk as ILI9341_Draw_Hollow_Circle*/
+static ILI9341_RAMFUNC void ILI9341_Band_Draw_Hollow_Circle(const ILI9341_Band_Command_TypeDef* Command)
+{
+	int X = Command->X;
+	int Y = Command->Y;
+	int Radius = Command->Size;
+	int x = Radius-1;
+	int y = 0;
+	int dx = 1;
+	int dy = 1;
+	int err = dx - (Radius << 1);
+
+	while (x >= y)
+	{
+		ILI9341_Band_Plot(X + x, Y + y, Command->Colour);
+		ILI9341_Band_Plot(X + y, Y + x, Command->Colour);
+		ILI9341_Band_Plot(X - y, Y + x, Command->Colour);
+		ILI9341_Band_Plot(X - x, Y + y, Command->Colour);
+		ILI9341_Band_Plot(X - x, Y - y, Command->Colour);
+		ILI9341_Band_Plot(X - y, Y - x, Command->Colour);
+		ILI9341_Band_Plot(X + y, Y - x, Command->Colour);
+		ILI9341_Band_Plot(X + x, Y - y, Command->Colour);
+
+		if (err <= 0)
+		{
+			y++;
+			err += dy;
+			dy += 2;
+		}
+		if (err > 0)
+		{
+			x--;
+			dx += 2;
+			err += (-Radius << 1) + dx;
+		}
+	}
+}
+
+/*Same spans as ILI9341_Draw_Filled_Circle*/
+static ILI9341_RAMFUNC void ILI9341_Band_Draw_Filled_Circle(const ILI9341_Band_Command_TypeDef* Command)
+{
+	int X = Command->X;
+	int Y = Command->Y;
+	int Radius = Command->Size;
+	int x = Radius;
+	int y = 0;
+	int xChange = 1 - (Radius << 1);
+	int yChange = 0;
+	int radiusError = 0;
+
+	while (x >= y)
+	{
+		ILI9341_Band_Fill(X - x, Y + y, X + x, Y + y, Command->Colour);
+		if (y != 0)
+		{
+			ILI9341_Band_Fill(X - x, Y - y, X + x, Y - y, Command->Colour);
+		}
+
+		y++;
+		radiusError += yChange;
+		yChange += 2;
+		if (((radiusError << 1) + xChange) > 0)
+		{
+			if (x > y - 1)
+			{
+				ILI9341_Band_Fill(X - (y - 1), Y + x, X + (y - 1), Y + x, Command->Colour);
+				ILI9341_Band_Fill(X - (y - 1), Y - x, X + (y - 1), Y - x, Command->Colour);
+			}
+			x--;
+			radiusError += xChange;
+			xChange += 2;
+		}
+	}
+}
+
+/*Same text box as ILI9341_Draw_Text, one scaled glyph column at a time*/
+static ILI9341_RAMFUNC void ILI9341_Band_Draw_Text(const ILI9341_Band_Command_TypeDef* Command)
+{
+	const char* text = Command->Data;
+	int size = Command->Size;
+	int x0 = (Command->Bounds.X0 < clip_x0) ? clip_x0 : Command->Bounds.X0;
+	int y0 = (Command->Bounds.Y0 < clip_y0) ? clip_y0 : Command->Bounds.Y0;
+	int x1 = (Command->Bounds.X1 > clip_x1) ? clip_x1 : Command->Bounds.X1;
+	int y1 = (Command->Bounds.Y1 > clip_y1) ? clip_y1 : Command->Bounds.Y1;
+
+	if((x0 > x1) || (y0 > y1)) return;
+	band_stats.Pixels_Rendered += (uint32_t)(x1 - x0 + 1)*(y1 - y0 + 1);
+
+	for(int y = y0; y <= y1; y++)
+	{
+		uint8_t bit = 1 << ((y - Command->Y) / size);
+		uint16_t* pixel = clip_buffer + (y - clip_y0)*clip_width + (x0 - clip_x0);
+		int column = (x0 - Command->X) / size;
+		int repeat = size - (x0 - Command->X) % size;
+		int c = column / CHAR_WIDTH;
+		int k = column % CHAR_WIDTH;
+		int x = x0;
+
+		while(x <= x1)
+		{
+			uint8_t function_char = text[c];
+			if((function_char < ' ') || (function_char > '~' + 1)) {
+				function_char = 0;
+			} else {
+				function_char -= 32;
+			}
+			uint16_t colour = (font[function_char][k] & bit) ? Command->Colour : Command->Background;
+			if(repeat > x1 - x + 1) repeat = x1 - x + 1;
+			x += repeat;
+			while(repeat--)
+			{
+				*pixel++ = colour;
+			}
+			repeat = size;
+			if(++k == CHAR_WIDTH)
+			{
+				k = 0;
+				c++;
+			}
+		}
+	}
+}
+
+static ILI9341_RAMFUNC void ILI9341_Band_Draw_Bitmap(const ILI9341_Band_Command_TypeDef* Command)
+{
+	int x0 = (Command->Bounds.X0 < clip_x0) ? clip_x0 : Command->Bounds.X0;
+	int y0 = (Command->Bounds.Y0 < clip_y0) ? clip_y0 : Command->Bounds.Y0;
+	int x1 = (Command->Bounds.X1 > clip_x1) ? clip_x1 : Command->Bounds.X1;
+	int y1 = (Command->Bounds.Y1 > clip_y1) ? clip_y1 : Command->Bounds.Y1;
+
+	if((x0 > x1) || (y0 > y1)) return;
+	band_stats.Pixels_Rendered += (uint32_t)(x1 - x0 + 1)*(y1 - y0 + 1);
+
+	for(int y = y0; y <= y1; y++)
+	{
+		const uint8_t* source = (const uint8_t*)Command->Data
+								+ ((uint32_t)(y - Command->Y)*Command->Length + (x0 - Command->X))*2;
+		memcpy(clip_buffer + (y - clip_y0)*clip_width + (x0 - clip_x0), source, (x1 - x0 + 1)*2);
+	}
+}
+
+/* Flushing */
+/**
+ * @brief  Rasterises the dirty areas band by band and sends them.
+ * @retval None
+ *
+ * Each band covering dirty pixels is sent through one address window: the
+ * bounding box of the dirty rectangles crossing it. Band k is rendered while
+ * band k-1 is still on the bus; the call returns once the last band has been
+ * started.
+ */
+void ILI9341_Band_End(void)
+{
+	ILI9341_PROFILE_FUNCTION(Band_End);
+	int band_rows = ILI9341_BAND_LINES*ILI9341_SCREEN_WIDTH / LCD_WIDTH;
+	uint8_t buffer = 0;
+
+	band_stats.Dirty_Rects = band_dirty_count;
+	if(band_dirty_count == 0) return;
+
+	ILI9341_Begin_Write();
+	for(int band_y = 0; band_y < LCD_HEIGHT; band_y += band_rows)
+	{
+		int band_end = band_y + band_rows - 1;
+		int x0 = LCD_WIDTH, y0 = LCD_HEIGHT, x1 = -1, y1 = -1;
+
+		if(band_end >= LCD_HEIGHT) band_end = LCD_HEIGHT - 1;
+		for(uint8_t i = 0; i < band_dirty_count; i++)
+		{
+			const ILI9341_Band_Rect_TypeDef* dirty = &band_dirty[i];
+			if((dirty->Y1 < band_y) || (dirty->Y0 > band_end)) continue;
+			if(dirty->X0 < x0) x0 = dirty->X0;
+			if(dirty->X1 > x1) x1 = dirty->X1;
+			if(dirty->Y0 < y0) y0 = (dirty->Y0 < band_y) ? band_y : dirty->Y0;
+			if(dirty->Y1 > y1) y1 = (dirty->Y1 > band_end) ? band_end : dirty->Y1;
+		}
+		if(x1 < 0) continue;
+
+		//the other buffer may still be on the bus; this one was sent two bands ago and is free
+		clip_buffer = band_buffer[buffer];
+		clip_x0 = x0;
+		clip_y0 = y0;
+		clip_x1 = x1;
+		clip_y1 = y1;
+		clip_width = x1 - x0 + 1;
+
+		ILI9341_Band_Fill(x0, y0, x1, y1, band_background);
+		for(uint16_t i = 0; i < band_command_count; i++)
+		{
+			const ILI9341_Band_Command_TypeDef* command = &band_commands[i];
+			if((command->Bounds.X1 < x0) || (command->Bounds.X0 > x1) ||
+			   (command->Bounds.Y1 < y0) || (command->Bounds.Y0 > y1)) continue;
+
+			switch(command->Type)
+			{
+				case ILI9341_BAND_RECT:
+					ILI9341_Band_Fill(command->Bounds.X0, command->Bounds.Y0, command->Bounds.X1, command->Bounds.Y1, command->Colour);
+					break;
+				case ILI9341_BAND_HOLLOW_CIRCLE:
+					ILI9341_Band_Draw_Hollow_Circle(command);
+					break;
+				case ILI9341_BAND_FILLED_CIRCLE:
+					ILI9341_Band_Draw_Filled_Circle(command);
+					break;
+				case ILI9341_BAND_TEXT:
+					ILI9341_Band_Draw_Text(command);
+					break;
+				case ILI9341_BAND_BITMAP:
+					ILI9341_Band_Draw_Bitmap(command);
+					break;
+				default:
+					break;
+			}
+		}
+
+		ILI9341_Set_Panel_Address(x0, y0, x1, y1);
+		ILI9341_Transmit_DMA((const uint8_t*)clip_buffer, (uint32_t)clip_width*(y1 - y0 + 1)*2);
+		band_stats.Windows++;
+		band_stats.Pixels_Sent += (uint32_t)clip_width*(y1 - y0 + 1);
+		buffer ^= 1;
+	}
+	ILI9341_End_Write();
+}
+
+/**
+ * @brief  Copies the counters of the current (or last finished) frame.
+ * @param  Stats: Destination.
+ * @retval None
+ */
+void ILI9341_Band_Get_Stats(ILI9341_Band_Stats_TypeDef* Stats)
+{
+	*Stats = band_stats;
+}
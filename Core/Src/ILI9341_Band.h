@@ -0,0 +1,48 @@
+/*
+ * ILI9341_Band.h
+ *
+ *  Created on: Nov 27, 2024
+ *      Author: ellis
+ */
+
+#ifndef SRC_ILI9341_BAND_H_
+#define SRC_ILI9341_BAND_H_
+
+#include "ILI9341.h"
+
+#ifndef ILI9341_BAND_LINES
+#define ILI9341_BAND_LINES			20		//landscape rows per band buffer; two buffers of 320*lines*2 bytes
+#endif
+#ifndef ILI9341_BAND_MAX_COMMANDS
+#define ILI9341_BAND_MAX_COMMANDS	128		//drawing commands recorded per frame
+#endif
+#ifndef ILI9341_BAND_TEXT_POOL
+#define ILI9341_BAND_TEXT_POOL		512		//bytes of text copied per frame
+#endif
+#ifndef ILI9341_BAND_MAX_DIRTY
+#define ILI9341_BAND_MAX_DIRTY		8		//dirty rectangles kept per frame, more are merged
+#endif
+
+typedef struct
+{
+	uint32_t Commands;			//commands recorded
+	uint32_t Dropped;			//commands that did not fit in the list or the text pool
+	uint32_t Dirty_Rects;		//dirty rectangles after merging
+	uint32_t Windows;			//address windows (bands) sent
+	uint32_t Pixels_Sent;		//pixels on the bus
+	uint32_t Pixels_Rendered;	//pixels written into band buffers, overdraw and background included
+} ILI9341_Band_Stats_TypeDef;
+
+void ILI9341_Band_Begin(uint16_t Background_Colour);
+void ILI9341_Band_Invalidate(int16_t X, int16_t Y, uint16_t Width, uint16_t Height);
+void ILI9341_Band_Invalidate_All(void);
+void ILI9341_Band_Fill_Rect(int16_t X, int16_t Y, uint16_t Width, uint16_t Height, uint16_t Colour);
+void ILI9341_Band_Pixel(int16_t X, int16_t Y, uint16_t Colour);
+void ILI9341_Band_Hollow_Circle(int16_t X, int16_t Y, uint16_t Radius, uint16_t Colour);
+void ILI9341_Band_Filled_Circle(int16_t X, int16_t Y, uint16_t Radius, uint16_t Colour);
+void ILI9341_Band_Text(const char* Text, int16_t X, int16_t Y, uint16_t Colour, uint16_t Size, uint16_t Background_Colour);
+void ILI9341_Band_Bitmap(int16_t X, int16_t Y, uint16_t Width, uint16_t Height, const uint8_t* Source, uint16_t Stride);
+void ILI9341_Band_End(void);
+void ILI9341_Band_Get_Stats(ILI9341_Band_Stats_TypeDef* Stats);
+
+#endif /* SRC_ILI9341_BAND_H_ */
@@ -0,0 +1,444 @@
+/*
+ * ILI9341_Bench.c
+ *
+ *  Created on: Nov 27, 2024
+ *      Author: ellis
+ *
+ *  Benchmark cases for the driver: one per drawing primitive plus the main.c
+ *  demo screens and a dashboard-style partial update, drawn directly, through
+ *  the band renderer and, with ILI9341_INDEXED, through the 8bpp framebuffer.
+ *  Coordinates, sizes and
+ *  colours come from a xorshift32 generator reseeded with ILI9341_BENCH_SEED
+ *  at the start of every case, so each case draws the same thing on target
+ *  and in the host simulator regardless of which cases ran before it.
+ *
+ *  Runs are timed with the DWT cycle counter up to the moment the bus is idle
+ *  again. Bytes and pixels come from ILI9341_Get_Traffic. A single run must
+ *  stay below 2^32 cycles (25 s at 168 MHz).
+ */
+
+#include <stdio.h>
+#include "ILI9341_Bench.h"
+#include "ILI9341_GFX.h"
+#include "ILI9341_Band.h"
+#include "ILI9341_Indexed.h"
+#include "ILI9341_Memory.h"
+
+typedef struct
+{
+	const char*	Name;
+	void		(*Run)(void);
+	uint16_t	Runs;
+	uint8_t		Needs_Picture;
+} ILI9341_Bench_Case_TypeDef;
+
+static uint32_t			bench_state;
+static const uint8_t*	bench_picture;		//240x320 RGB565 picture, display byte order
+static ILI9341_Point_TypeDef bench_points[ILI9341_PIXELS_BATCH] ILI9341_CCMRAM;
+
+/**
+ * @brief  xorshift32, stands in for HAL_RNG_GetRandomNumber with a fixed seed.
+ */
+static uint32_t ILI9341_Bench_Random(void)
+{
+	bench_state ^= bench_state << 13;
+	bench_state ^= bench_state >> 17;
+	bench_state ^= bench_state << 5;
+	return bench_state;
+}
+
+/**
+ * @brief  Random value in 0..Limit-1.
+ */
+static uint32_t ILI9341_Bench_Below(uint32_t Limit)
+{
+	return ILI9341_Bench_Random() % Limit;
+}
+
+/* Primitives */
+static void ILI9341_Bench_Fill_Screen(void)
+{
+	ILI9341_Fill_Screen(ILI9341_Bench_Random());
+}
+
+static void ILI9341_Bench_Pixel(void)
+{
+	for(uint32_t i = 0; i < 1024; i++)
+	{
+		ILI9341_Draw_Pixel(ILI9341_Bench_Below(LCD_WIDTH), ILI9341_Bench_Below(LCD_HEIGHT), ILI9341_Bench_Random());
+	}
+}
+
+static void ILI9341_Bench_Pixels_Batch(void)
+{
+	uint16_t colour = ILI9341_Bench_Random();
+
+	for(uint32_t i = 0; i < 1024; i += ILI9341_PIXELS_BATCH)
+	{
+		for(uint32_t j = 0; j < ILI9341_PIXELS_BATCH; j++)
+		{
+			bench_points[j].X = ILI9341_Bench_Below(LCD_WIDTH);
+			bench_points[j].Y = ILI9341_Bench_Below(LCD_HEIGHT);
+		}
+		ILI9341_Draw_Pixels(bench_points, ILI9341_PIXELS_BATCH, colour);
+	}
+}
+
+static void ILI9341_Bench_Horizontal_Line(void)
+{
+	for(uint32_t i = 0; i < 200; i++)
+	{
+		uint16_t x = ILI9341_Bench_Below(LCD_WIDTH);
+		ILI9341_Draw_Horizontal_Line(x, ILI9341_Bench_Below(LCD_HEIGHT), 1 + ILI9341_Bench_Below(LCD_WIDTH - x), ILI9341_Bench_Random());
+	}
+}
+
+static void ILI9341_Bench_Vertical_Line(void)
+{
+	for(uint32_t i = 0; i < 200; i++)
+	{
+		uint16_t y = ILI9341_Bench_Below(LCD_HEIGHT);
+		ILI9341_Draw_Vertical_Line(ILI9341_Bench_Below(LCD_WIDTH), y, 1 + ILI9341_Bench_Below(LCD_HEIGHT - y), ILI9341_Bench_Random());
+	}
+}
+
+static void ILI9341_Bench_Rectangle_16(void)
+{
+	for(uint32_t i = 0; i < 200; i++)
+	{
+		ILI9341_Draw_Rectangle(ILI9341_Bench_Below(LCD_WIDTH - 16), ILI9341_Bench_Below(LCD_HEIGHT - 16), 16, 16, ILI9341_Bench_Random());
+	}
+}
+
+static void ILI9341_Bench_Rectangle_100(void)
+{
+	for(uint32_t i = 0; i < 20; i++)
+	{
+		ILI9341_Draw_Rectangle(ILI9341_Bench_Below(LCD_WIDTH - 100), ILI9341_Bench_Below(LCD_HEIGHT - 100), 100, 100, ILI9341_Bench_Random());
+	}
+}
+
+static void ILI9341_Bench_Hollow_Rectangle(void)
+{
+	for(uint32_t i = 0; i < 100; i++)
+	{
+		uint16_t x = ILI9341_Bench_Below(LCD_WIDTH - 1);
+		uint16_t y = ILI9341_Bench_Below(LCD_HEIGHT - 1);
+		ILI9341_Draw_Hollow_Rectangle_Coord(x, y, x + 1 + ILI9341_Bench_Below(LCD_WIDTH - 1 - x),
+											y + 1 + ILI9341_Bench_Below(LCD_HEIGHT - 1 - y), ILI9341_Bench_Random());
+	}
+}
+
+/*Same distribution as the main.c circle demo*/
+static void ILI9341_Bench_Random_Circles(uint32_t Count)
+{
+	for(uint32_t i = 0; i < Count; i++)
+	{
+		uint16_t xr = ILI9341_Bench_Random() & 0x01FF;
+		uint16_t yr = ILI9341_Bench_Random() & 0x01FF;
+		uint16_t radiusr = ILI9341_Bench_Random() & 0x001F;
+		uint16_t colourr = ILI9341_Bench_Random();
+		ILI9341_Draw_Hollow_Circle(xr, yr, radiusr*2, colourr);
+	}
+}
+
+static void ILI9341_Bench_Hollow_Circle(void)
+{
+	ILI9341_Bench_Random_Circles(100);
+}
+
+static void ILI9341_Bench_Filled_Circle(void)
+{
+	for(uint32_t i = 0; i < 20; i++)
+	{
+		ILI9341_Draw_Filled_Circle(ILI9341_Bench_Below(LCD_WIDTH), ILI9341_Bench_Below(LCD_HEIGHT),
+								   ILI9341_Bench_Below(63), ILI9341_Bench_Random());
+	}
+}
+
+static void ILI9341_Bench_Char(void)
+{
+	for(uint32_t i = 0; i < 200; i++)
+	{
+		ILI9341_Draw_Char(' ' + ILI9341_Bench_Below(95), ILI9341_Bench_Below(LCD_WIDTH - 6), ILI9341_Bench_Below(LCD_HEIGHT - 8),
+						  BLACK, 1, WHITE);
+	}
+}
+
+static void ILI9341_Bench_Text_1(void)
+{
+	for(uint16_t y = 0; y < 240; y += 10)
+	{
+		ILI9341_Draw_Text("The quick brown fox jumps over the lazy dog", 0, y, BLACK, 1, WHITE);
+	}
+}
+
+static void ILI9341_Bench_Text_2(void)
+{
+	for(uint16_t y = 0; y < 240; y += 20)
+	{
+		ILI9341_Draw_Text("Quick brown fox jumps", 0, y, BLUE, 2, WHITE);
+	}
+}
+
+static void ILI9341_Bench_Bitmap_64(void)
+{
+	for(uint32_t i = 0; i < 20; i++)
+	{
+		const uint8_t* source = bench_picture + (ILI9341_Bench_Below(240 - 64) + ILI9341_Bench_Below(320 - 64)*240)*2;
+		ILI9341_Draw_Bitmap(ILI9341_Bench_Below(LCD_WIDTH - 64), ILI9341_Bench_Below(LCD_HEIGHT - 64), 64, 64, source, 240);
+	}
+}
+
+static void ILI9341_Bench_Image(void)
+{
+	ILI9341_Draw_Image((const char*)bench_picture, SCREEN_VERTICAL_2);
+	ILI9341_Set_Rotation(SCREEN_HORIZONTAL_2);
+}
+
+/* Workloads */
+/*main.c "FPS TEST" screen*/
+static void ILI9341_Bench_FPS_Text(void)
+{
+	ILI9341_Fill_Screen(WHITE);
+	ILI9341_Draw_Text("FPS TEST, 40 loop 2 screens", 10, 10, BLACK, 1, WHITE);
+}
+
+/*main.c "Counting multiple segments" screen*/
+static void ILI9341_Bench_Counting(void)
+{
+	static const uint16_t colours[11] = {BLACK, BLUE, RED, GREEN, BLACK, BLUE, RED, GREEN, WHITE, BLUE, RED};
+	char text[40];
+
+	for(uint16_t i = 0; i <= 10; i++)
+	{
+		sprintf(text, "Counting: %d", i);
+		for(uint16_t j = 0; j < 11; j++)
+		{
+			ILI9341_Draw_Text(text, 10, 10 + j*20, colours[j], 2, (j < 8) ? WHITE : BLACK);
+		}
+	}
+}
+
+/*main.c random circles screen*/
+static void ILI9341_Bench_Circles_3000(void)
+{
+	ILI9341_Bench_Random_Circles(3000);
+}
+
+/*Partial update of a status screen: four numeric readouts and a 16-bar graph*/
+static void ILI9341_Bench_Dashboard(void)
+{
+	char text[12];
+
+	ILI9341_Draw_Rectangle(0, 0, 320, 24, NAVY);
+	ILI9341_Draw_Text("DASHBOARD", 8, 6, WHITE, 2, NAVY);
+	for(uint16_t i = 0; i < 4; i++)
+	{
+		sprintf(text, "%5lu", (unsigned long)ILI9341_Bench_Below(100000));
+		ILI9341_Draw_Text(text, 8 + i*80, 40, BLACK, 2, WHITE);
+	}
+	for(uint16_t i = 0; i < 16; i++)
+	{
+		uint16_t x = 8 + i*19;
+		uint16_t height = 1 + ILI9341_Bench_Below(139);
+		ILI9341_Draw_Rectangle(x, 80, 16, 140 - height, WHITE);
+		ILI9341_Draw_Rectangle(x, 220 - height, 16, height, (height > 100) ? RED : DARKGREEN);
+	}
+	ILI9341_Draw_Horizontal_Line(0, 221, 320, BLACK);
+}
+
+/*Same scene through the band renderer; the header does not change, so only the values and bars are sent*/
+static void ILI9341_Bench_Dashboard_Band(void)
+{
+	char text[12];
+
+	ILI9341_Band_Begin(WHITE);
+	ILI9341_Band_Invalidate(8, 40, 304, 16);
+	ILI9341_Band_Invalidate(8, 80, 304, 142);
+	ILI9341_Band_Fill_Rect(0, 0, 320, 24, NAVY);
+	ILI9341_Band_Text("DASHBOARD", 8, 6, WHITE, 2, NAVY);
+	for(uint16_t i = 0; i < 4; i++)
+	{
+		sprintf(text, "%5lu", (unsigned long)ILI9341_Bench_Below(100000));
+		ILI9341_Band_Text(text, 8 + i*80, 40, BLACK, 2, WHITE);
+	}
+	for(uint16_t i = 0; i < 16; i++)
+	{
+		uint16_t x = 8 + i*19;
+		uint16_t height = 1 + ILI9341_Bench_Below(139);
+		ILI9341_Band_Fill_Rect(x, 220 - height, 16, height, (height > 100) ? RED : DARKGREEN);
+	}
+	ILI9341_Band_Fill_Rect(0, 221, 320, 1, BLACK);
+	ILI9341_Band_End();
+}
+
+#if ILI9341_INDEXED
+/*Same scene drawn into the indexed framebuffer, then the changed rows flushed*/
+static void ILI9341_Bench_Dashboard_Indexed(void)
+{
+	char text[12];
+
+	ILI9341_Set_Render_Mode(ILI9341_RENDER_INDEXED);
+	ILI9341_Draw_Rectangle(0, 0, 320, 24, ILI9341_INDEX(NAVY));
+	ILI9341_Draw_Text("DASHBOARD", 8, 6, ILI9341_INDEX(WHITE), 2, ILI9341_INDEX(NAVY));
+	for(uint16_t i = 0; i < 4; i++)
+	{
+		sprintf(text, "%5lu", (unsigned long)ILI9341_Bench_Below(100000));
+		ILI9341_Draw_Text(text, 8 + i*80, 40, ILI9341_INDEX(BLACK), 2, ILI9341_INDEX(WHITE));
+	}
+	for(uint16_t i = 0; i < 16; i++)
+	{
+		uint16_t x = 8 + i*19;
+		uint16_t height = 1 + ILI9341_Bench_Below(139);
+		ILI9341_Draw_Rectangle(x, 80, 16, 140 - height, ILI9341_INDEX(WHITE));
+		ILI9341_Draw_Rectangle(x, 220 - height, 16, height, (height > 100) ? ILI9341_INDEX(RED) : ILI9341_INDEX(DARKGREEN));
+	}
+	ILI9341_Draw_Horizontal_Line(0, 221, 320, ILI9341_INDEX(BLACK));
+	ILI9341_Indexed_Flush();
+	ILI9341_Set_Render_Mode(ILI9341_RENDER_DIRECT);
+}
+
+/*Palette animation: one entry changes, the whole framebuffer is re-sent without redrawing*/
+static void ILI9341_Bench_Palette_Cycle(void)
+{
+	uint16_t colour = ILI9341_Bench_Below(0x10000);
+
+	ILI9341_Set_Render_Mode(ILI9341_RENDER_INDEXED);
+	ILI9341_Indexed_Set_Palette(ILI9341_INDEX(NAVY), 1, &colour);
+	ILI9341_Indexed_Flush();
+	ILI9341_Set_Render_Mode(ILI9341_RENDER_DIRECT);
+}
+#endif
+
+static const ILI9341_Bench_Case_TypeDef bench_cases[] =
+{
+	{"fill_screen",		ILI9341_Bench_Fill_Screen,		10, 0},
+	{"pixel",			ILI9341_Bench_Pixel,			10, 0},
+	{"pixels_batch",	ILI9341_Bench_Pixels_Batch,		10, 0},
+	{"hline",			ILI9341_Bench_Horizontal_Line,	10, 0},
+	{"vline",			ILI9341_Bench_Vertical_Line,	10, 0},
+	{"rect_16",			ILI9341_Bench_Rectangle_16,		10, 0},
+	{"rect_100",		ILI9341_Bench_Rectangle_100,	10, 0},
+	{"hollow_rect",		ILI9341_Bench_Hollow_Rectangle,	10, 0},
+	{"hollow_circle",	ILI9341_Bench_Hollow_Circle,	10, 0},
+	{"filled_circle",	ILI9341_Bench_Filled_Circle,	10, 0},
+	{"char",			ILI9341_Bench_Char,				10, 0},
+	{"text_1",			ILI9341_Bench_Text_1,			10, 0},
+	{"text_2",			ILI9341_Bench_Text_2,			10, 0},
+	{"bitmap_64",		ILI9341_Bench_Bitmap_64,		10, 1},
+	{"image_full",		ILI9341_Bench_Image,			10, 1},
+	{"fps_text",		ILI9341_Bench_FPS_Text,			10, 0},
+	{"counting",		ILI9341_Bench_Counting,			3, 0},
+	{"circles_3000",	ILI9341_Bench_Circles_3000,		1, 0},
+	{"dashboard",		ILI9341_Bench_Dashboard,		20, 0},
+	{"dashboard_band",	ILI9341_Bench_Dashboard_Band,	20, 0},
+#if ILI9341_INDEXED
+	{"dashboard_indexed",	ILI9341_Bench_Dashboard_Indexed,	20, 0},
+	{"palette_cycle",	ILI9341_Bench_Palette_Cycle,	10, 0},
+#endif
+};
+
+#define ILI9341_BENCH_CASES		(sizeof(bench_cases)/sizeof(bench_cases[0]))
+
+/**
+ * @brief  Returns the number of benchmark cases.
+ */
+uint32_t ILI9341_Bench_Count(void)
+{
+	return ILI9341_BENCH_CASES;
+}
+
+/**
+ * @brief  Returns the name of a benchmark case, NULL past the last one.
+ */
+const char* ILI9341_Bench_Name(uint32_t Index)
+{
+	return (Index < ILI9341_BENCH_CASES) ? bench_cases[Index].Name : NULL;
+}
+
+/**
+ * @brief  Runs one benchmark case.
+ * @param  Index: Case number, 0 to ILI9341_Bench_Count() - 1.
+ * @param  Picture: 240x320 RGB565 picture in display byte order (like snow_tiger),
+ *         NULL to skip the cases that stream an image.
+ * @param  Result: Measured figures, Runs is 0 when the case was skipped.
+ * @retval None
+ *
+ * The display must be initialised. The screen is cleared in landscape
+ * (SCREEN_HORIZONTAL_2) before the first run; the clear is not timed.
+ */
+void ILI9341_Bench_Run(uint32_t Index, const uint8_t* Picture, ILI9341_Bench_Result_TypeDef* Result)
+{
+	const ILI9341_Bench_Case_TypeDef* bench = &bench_cases[Index];
+	ILI9341_Traffic_TypeDef before, after;
+	uint64_t cycles = 0;
+	uint32_t cycles_per_us = SystemCoreClock / 1000000;
+
+	Result->Name = bench->Name;
+	Result->Runs = 0;
+	Result->Time_us = 0;
+	Result->Pixels = 0;
+	Result->Bytes = 0;
+	Result->Pixels_Per_s = 0;
+	Result->Frames_Per_s_x100 = 0;
+	Result->Bytes_Per_s = 0;
+	if(bench->Needs_Picture && (Picture == NULL)) return;
+
+	bench_picture = Picture;
+	bench_state = ILI9341_BENCH_SEED;
+	ILI9341_Set_Rotation(SCREEN_HORIZONTAL_2);
+	ILI9341_Fill_Screen(WHITE);
+	ILI9341_Wait_Idle();
+
+	ILI9341_Get_Traffic(&before);
+	for(uint32_t i = 0; i < bench->Runs; i++)
+	{
+		uint32_t start = ILI9341_Cycles();
+		bench->Run();
+		ILI9341_Wait_Idle();
+		cycles += (uint32_t)(ILI9341_Cycles() - start);
+	}
+	ILI9341_Get_Traffic(&after);
+
+	Result->Runs = bench->Runs;
+	Result->Time_us = cycles / cycles_per_us;
+	Result->Pixels = after.Pixels - before.Pixels;
+	Result->Bytes = after.Bytes - before.Bytes;
+	if(cycles != 0)
+	{
+		Result->Pixels_Per_s = (uint64_t)Result->Pixels * SystemCoreClock / cycles;
+		Result->Frames_Per_s_x100 = (uint64_t)Result->Runs * 100 * SystemCoreClock / cycles;
+		Result->Bytes_Per_s = (uint64_t)Result->Bytes * SystemCoreClock / cycles;
+	}
+}
+
+/**
+ * @brief  Runs every case and prints the results as CSV with printf.
+ * @param  Picture: See ILI9341_Bench_Run.
+ * @retval None
+ *
+ * On target printf goes to USART1 (__io_putchar in Utility.c). Lines starting
+ * with '#' are comments; skipped cases are left out.
+ */
+void ILI9341_Bench_Run_All(const uint8_t* Picture)
+{
+	ILI9341_Bench_Result_TypeDef result;
+	ILI9341_Transfer_Stats_TypeDef transfer;
+
+	printf("# ILI9341 benchmark, core %lu Hz, seed 0x%08lX\n", (unsigned long)SystemCoreClock, (unsigned long)ILI9341_BENCH_SEED);
+	printf("# hot code in %s, working sets in %s\n", ILI9341_RAM_CODE ? "SRAM" : "flash", ILI9341_USE_CCMRAM ? "CCM RAM" : "SRAM");
+	printf("case,runs,time_us,pixels,bytes,pixels_per_s,frames_per_s,bytes_per_s\n");
+	for(uint32_t i = 0; i < ILI9341_BENCH_CASES; i++)
+	{
+		ILI9341_Bench_Run(i, Picture, &result);
+		if(result.Runs == 0) continue;
+		printf("%s,%lu,%lu,%lu,%lu,%lu,%lu.%02lu,%lu\n", result.Name, (unsigned long)result.Runs,
+			   (unsigned long)result.Time_us, (unsigned long)result.Pixels, (unsigned long)result.Bytes,
+			   (unsigned long)result.Pixels_Per_s, (unsigned long)(result.Frames_Per_s_x100 / 100),
+			   (unsigned long)(result.Frames_Per_s_x100 % 100), (unsigned long)result.Bytes_Per_s);
+	}
+	ILI9341_Get_Transfer_Stats(&transfer);
+	printf("# transfer buffers: %lu, peak %lu, waits %lu, failures %lu\n", (unsigned long)transfer.Buffers,
+		   (unsigned long)transfer.Peak, (unsigned long)transfer.Waits, (unsigned long)transfer.Failures);
+}
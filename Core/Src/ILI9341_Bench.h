@@ -0,0 +1,32 @@
+/*
+ * ILI9341_Bench.h
+ *
+ *  Created on: Nov 27, 2024
+ *      Author: ellis
+ */
+
+#ifndef SRC_ILI9341_BENCH_H_
+#define SRC_ILI9341_BENCH_H_
+
+#include "ILI9341.h"
+
+#define ILI9341_BENCH_SEED		0x2545F491u		//xorshift32 seed, reloaded at the start of every case
+
+typedef struct
+{
+	const char*	Name;
+	uint32_t	Runs;				//frames drawn, one run of a case is one frame; 0 when skipped
+	uint32_t	Time_us;			//all runs, each timed until the bus is idle
+	uint32_t	Pixels;				//pixels written into display RAM
+	uint32_t	Bytes;				//bytes clocked out on SPI2, commands included
+	uint32_t	Pixels_Per_s;
+	uint32_t	Frames_Per_s_x100;	//frames per second times 100
+	uint32_t	Bytes_Per_s;
+} ILI9341_Bench_Result_TypeDef;
+
+uint32_t ILI9341_Bench_Count(void);
+const char* ILI9341_Bench_Name(uint32_t Index);
+void ILI9341_Bench_Run(uint32_t Index, const uint8_t* Picture, ILI9341_Bench_Result_TypeDef* Result);
+void ILI9341_Bench_Run_All(const uint8_t* Picture);
+
+#endif /* SRC_ILI9341_BENCH_H_ */
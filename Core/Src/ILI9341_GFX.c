@@ -6,7 +6,12 @@
  */
 
 #include "ILI9341_GFX.h"
+#include "ILI9341_Profile.h"
+#include "ILI9341_Indexed.h"
+#include "ILI9341_Memory.h"
+#include <string.h>
 
+static ILI9341_Point_TypeDef circle_points[ILI9341_PIXELS_BATCH] ILI9341_CCMRAM;	//outline batch of ILI9341_Draw_Hollow_Circle, kept off the stack
 
 /*Draw hollow circle at X,Y location with specified radius and colour. X and Y represent circles center */
 /**
@@ -14,30 +19,43 @@
  * 
  * This function uses the Bresenham's circle algorithm to draw a hollow circle
  * with the specified radius and color at the given coordinates (X, Y).
+ * The eight octant points of each step are collected and handed to
+ * ILI9341_Draw_Pixels, which merges neighbouring pixels into runs and sends
+ * the whole outline in a single transaction.
  * 
  * @param X The X coordinate of the center of the circle.
  * @param Y The Y coordinate of the center of the circle.
  * @param Radius The radius of the circle.
  * @param Colour The color of the circle.
  */
-void ILI9341_Draw_Hollow_Circle(uint16_t X, uint16_t Y, uint16_t Radius, uint16_t Colour)
+ILI9341_RAMFUNC void ILI9341_Draw_Hollow_Circle(uint16_t X, uint16_t Y, uint16_t Radius, uint16_t Colour)
 {
+	ILI9341_PROFILE_FUNCTION(Draw_Hollow_Circle);
+	uint32_t n = 0;
 	int x = Radius-1;
     int y = 0;
     int dx = 1;
     int dy = 1;
     int err = dx - (Radius << 1);
+    uint8_t hold = ILI9341_RENDERS_TO_PANEL();	//no CS for the indexed framebuffer
 
+	if(hold) ILI9341_Begin_Write();
     while (x >= y)
     {
-        ILI9341_Draw_Pixel(X + x, Y + y, Colour);
-        ILI9341_Draw_Pixel(X + y, Y + x, Colour);
-        ILI9341_Draw_Pixel(X - y, Y + x, Colour);
-        ILI9341_Draw_Pixel(X - x, Y + y, Colour);
-        ILI9341_Draw_Pixel(X - x, Y - y, Colour);
-        ILI9341_Draw_Pixel(X - y, Y - x, Colour);
-        ILI9341_Draw_Pixel(X + y, Y - x, Colour);
-        ILI9341_Draw_Pixel(X + x, Y - y, Colour);
+        if (n > ILI9341_PIXELS_BATCH - 8)
+        {
+            ILI9341_Draw_Pixels(circle_points, n, Colour);
+            n = 0;
+        }
+        //off-screen points wrap to large values and are clipped by ILI9341_Draw_Pixels
+        circle_points[n++] = (ILI9341_Point_TypeDef){X + x, Y + y};
+        circle_points[n++] = (ILI9341_Point_TypeDef){X + y, Y + x};
+        circle_points[n++] = (ILI9341_Point_TypeDef){X - y, Y + x};
+        circle_points[n++] = (ILI9341_Point_TypeDef){X - x, Y + y};
+        circle_points[n++] = (ILI9341_Point_TypeDef){X - x, Y - y};
+        circle_points[n++] = (ILI9341_Point_TypeDef){X - y, Y - x};
+        circle_points[n++] = (ILI9341_Point_TypeDef){X + y, Y - x};
+        circle_points[n++] = (ILI9341_Point_TypeDef){X + x, Y - y};
 
         if (err <= 0)
         {
@@ -52,9 +70,29 @@ void ILI9341_Draw_Hollow_Circle(uint16_t X, uint16_t Y, uint16_t Radius, uint16_
             err += (-Radius << 1) + dx;
         }
     }
+    ILI9341_Draw_Pixels(circle_points, n, Colour);
+    if(hold) ILI9341_End_Write();
 }
 
 
+/*Draw one horizontal span of a shape, clipped to the screen*/
+/**
+ * @brief  Fills the pixels X0..X1 of row Y, clipping the span to the screen.
+ * @param  X0: Left end of the span, may be off screen.
+ * @param  X1: Right end of the span, may be off screen.
+ * @param  Y: Row of the span, may be off screen.
+ * @param  Colour: The color of the span.
+ * @retval None
+ */
+static void ILI9341_Draw_Span(int X0, int X1, int Y, uint16_t Colour)
+{
+	if((Y < 0) || (Y >= LCD_HEIGHT)) return;
+	if(X0 < 0) X0 = 0;
+	if(X1 >= LCD_WIDTH) X1 = LCD_WIDTH - 1;
+	if(X0 > X1) return;
+	ILI9341_Draw_Horizontal_Line(X0, Y, X1 - X0 + 1, Colour);
+}
+
 /*Draw filled circle at X,Y location with specified radius and colour. X and Y represent circles center */
 /**
  * @brief  Draws a filled circle on the ILI9341 display.
@@ -63,44 +101,46 @@ void ILI9341_Draw_Hollow_Circle(uint16_t X, uint16_t Y, uint16_t Radius, uint16_
  * @param  Radius: The radius of the circle.
  * @param  Colour: The color of the circle.
  * @retval None
- * @note   This implementation is not optimized for performance and may be slow.
- *         Future improvements can be made by referring to:
- *         https://stackoverflow.com/questions/1201200/fast-algorithm-for-drawing-filled-circles
+ * @note   The circle is rasterised with the midpoint algorithm into horizontal
+ *         spans. Every row is sent exactly once as an address window plus a
+ *         colour burst, and spans are clipped to the screen beforehand, so a
+ *         radius 60 circle costs about 121 small transactions instead of one
+ *         per pixel.
  */
-void ILI9341_Draw_Filled_Circle(uint16_t X, uint16_t Y, uint16_t Radius, uint16_t Colour)
+ILI9341_RAMFUNC void ILI9341_Draw_Filled_Circle(uint16_t X, uint16_t Y, uint16_t Radius, uint16_t Colour)
 {
+	ILI9341_PROFILE_FUNCTION(Draw_Filled_Circle);
+	int x = Radius;
+	int y = 0;
+	int xChange = 1 - (Radius << 1);
+	int yChange = 0;
+	int radiusError = 0;
+
+	while (x >= y)
+	{
+		//rows Y+-y, one per step since y always advances
+		ILI9341_Draw_Span(X - x, X + x, Y + y, Colour);
+		if (y != 0)
+		{
+			ILI9341_Draw_Span(X - x, X + x, Y - y, Colour);
+		}
 
-		int x = Radius;
-    int y = 0;
-    int xChange = 1 - (Radius << 1);
-    int yChange = 0;
-    int radiusError = 0;
-
-    while (x >= y)
-    {
-        for (int i = X - x; i <= X + x; i++)
-        {
-            ILI9341_Draw_Pixel(i, Y + y,Colour);
-            ILI9341_Draw_Pixel(i, Y - y,Colour);
-        }
-        for (int i = X - y; i <= X + y; i++)
-        {
-            ILI9341_Draw_Pixel(i, Y + x,Colour);
-            ILI9341_Draw_Pixel(i, Y - x,Colour);
-        }
-
-        y++;
-        radiusError += yChange;
-        yChange += 2;
-        if (((radiusError << 1) + xChange) > 0)
-        {
-            x--;
-            radiusError += xChange;
-            xChange += 2;
-        }
-    }
-		//Really slow implementation, will require future overhaul
-		//TODO:	https://stackoverflow.com/questions/1201200/fast-algorithm-for-drawing-filled-circles
+		y++;
+		radiusError += yChange;
+		yChange += 2;
+		if (((radiusError << 1) + xChange) > 0)
+		{
+			//rows Y+-x are complete once x moves on; skip them if already drawn as Y+-y rows
+			if (x > y - 1)
+			{
+				ILI9341_Draw_Span(X - (y - 1), X + (y - 1), Y + x, Colour);
+				ILI9341_Draw_Span(X - (y - 1), X + (y - 1), Y - x, Colour);
+			}
+			x--;
+			radiusError += xChange;
+			xChange += 2;
+		}
+	}
 }
 
 /*Draw a hollow rectangle between positions X0,Y0 and X1,Y1 with specified colour*/
@@ -120,6 +160,7 @@ void ILI9341_Draw_Filled_Circle(uint16_t X, uint16_t Y, uint16_t Radius, uint16_
  */
 void ILI9341_Draw_Hollow_Rectangle_Coord(uint16_t X0, uint16_t Y0, uint16_t X1, uint16_t Y1, uint16_t Colour)
 {
+	ILI9341_PROFILE_FUNCTION(Draw_Hollow_Rectangle_Coord);
 	uint16_t 	X_length = 0;
 	uint16_t 	Y_length = 0;
 	uint8_t		Negative_X = 0;
@@ -183,6 +224,7 @@ void ILI9341_Draw_Hollow_Rectangle_Coord(uint16_t X0, uint16_t Y0, uint16_t X1,
  */
 void ILI9341_Draw_Filled_Rectangle_Coord(uint16_t X0, uint16_t Y0, uint16_t X1, uint16_t Y1, uint16_t Colour)
 {
+	ILI9341_PROFILE_FUNCTION(Draw_Filled_Rectangle_Coord);
 	uint16_t 	X_length = 0;
 	uint16_t 	Y_length = 0;
 	uint8_t		Negative_X = 0;
@@ -227,6 +269,82 @@ void ILI9341_Draw_Filled_Rectangle_Coord(uint16_t X0, uint16_t Y0, uint16_t X1,
 	ILI9341_Draw_Rectangle(X0_true, Y0_true, X_length, Y_length, Colour);
 }
 
+/**
+ * @brief  Renders a run of characters through one address window.
+ * @param  Text: Characters to draw, Count of them (no terminator needed).
+ * @param  Count: Number of characters.
+ * @param  X: The X coordinate of the top-left corner of the first character.
+ * @param  Y: The Y coordinate of the top-left corner of the first character.
+ * @param  Colour: The color of the characters.
+ * @param  Size: The size multiplier for the characters.
+ * @param  Background_Colour: The background color of the characters.
+ * @retval None
+ * 
+ * The text box is clipped to the screen, then rendered scanline by scanline,
+ * glyphs scaled and background included, into the DMA back buffer. Whole rows
+ * are sent in bands while the next band is rendered into the other buffer,
+ * all inside a single window and CS assertion. Nothing is drawn when the
+ * application holds every transfer buffer.
+ */
+static ILI9341_RAMFUNC void ILI9341_Draw_Glyphs(const char* Text, uint16_t Count, uint16_t X, uint16_t Y, uint16_t Colour, uint16_t Size, uint16_t Background_Colour)
+{
+#if ILI9341_INDEXED
+	if(ILI9341_Get_Render_Mode() == ILI9341_RENDER_INDEXED)
+	{
+		ILI9341_Indexed_Draw_Glyphs(Text, Count, X, Y, Colour, Size, Background_Colour);
+		return;
+	}
+#endif
+	if((Count == 0) || (Size == 0) || (X >= LCD_WIDTH) || (Y >= LCD_HEIGHT)) return;
+
+	//CLIP THE TEXT BOX TO THE SCREEN
+	uint32_t box_width = (uint32_t)Count*CHAR_WIDTH*Size;
+	uint32_t box_height = (uint32_t)CHAR_HEIGHT*Size;
+	uint16_t width = (X + box_width > LCD_WIDTH) ? (uint32_t)(LCD_WIDTH - X) : box_width;
+	uint16_t height = (Y + box_height > LCD_HEIGHT) ? (uint32_t)(LCD_HEIGHT - Y) : box_height;
+	uint16_t band_rows = ILI9341_DMA_BUFFER_SIZE / (width*2);
+
+	//colours pre-swapped so a half-word store gives display byte order
+	uint16_t fore = (Colour >> 8) | (Colour << 8);
+	uint16_t back = (Background_Colour >> 8) | (Background_Colour << 8);
+
+	if(ILI9341_Get_Back_Buffer() == NULL) return;
+	ILI9341_Begin_Write();
+	ILI9341_Set_Address(X, Y, X+width-1, Y+height-1);
+	for(uint16_t row = 0; row < height; row += band_rows)
+	{
+		uint16_t rows = (height - row < band_rows) ? height - row : band_rows;
+		uint16_t* pixel = (uint16_t*)ILI9341_Get_Back_Buffer();
+		for(uint16_t i = row; i < row + rows; i++)
+		{
+			uint8_t bit = 1 << (i / Size);
+			uint16_t remaining = width;
+			for(uint16_t c = 0; remaining != 0; c++)
+			{
+				uint8_t function_char = Text[c];
+				if((function_char < ' ') || (function_char > '~' + 1)) {
+					function_char = 0;
+				} else {
+					function_char -= 32;
+				}
+				const unsigned char* glyph = font[function_char];
+				for(uint8_t k = 0; (k < CHAR_WIDTH) && (remaining != 0); k++)
+				{
+					uint16_t colour = (glyph[k] & bit) ? fore : back;
+					uint16_t repeat = (Size < remaining) ? Size : remaining;
+					remaining -= repeat;
+					while(repeat--)
+					{
+						*pixel++ = colour;
+					}
+				}
+			}
+		}
+		ILI9341_Send_Back_Buffer(rows*width*2);
+	}
+	ILI9341_End_Write();
+}
+
 /*Draws a character (fonts imported from fonts.h) at X,Y location with specified font colour, size and Background colour*/
 /*See fonts.h implementation of font on what is required for changing to a different font when switching fonts libraries*/
 /**
@@ -238,42 +356,14 @@ void ILI9341_Draw_Filled_Rectangle_Coord(uint16_t X0, uint16_t Y0, uint16_t X1,
  * @param  Size: The size multiplier for the character.
  * @param  Background_Colour: The background color of the character.
  * @retval None
+ * 
+ * The glyph is expanded, scaled and clipped, together with its background,
+ * into the DMA back buffer and sent through a single address window.
  */
-void ILI9341_Draw_Char(char Character, uint8_t X, uint8_t Y, uint16_t Colour, uint16_t Size, uint16_t Background_Colour)
+void ILI9341_Draw_Char(char Character, uint16_t X, uint16_t Y, uint16_t Colour, uint16_t Size, uint16_t Background_Colour)
 {
-		uint8_t 	function_char;
-    uint8_t 	i,j;
-
-		function_char = Character;
-
-    if (function_char < ' ') {
-        Character = 0;
-    } else {
-        function_char -= 32;
-		}
-
-		char temp[CHAR_WIDTH];
-		for(uint8_t k = 0; k<CHAR_WIDTH; k++)
-		{
-		temp[k] = font[function_char][k];
-		}
-
-    // Draw pixels
-		ILI9341_Draw_Rectangle(X, Y, CHAR_WIDTH*Size, CHAR_HEIGHT*Size, Background_Colour);
-    for (j=0; j<CHAR_WIDTH; j++) {
-        for (i=0; i<CHAR_HEIGHT; i++) {
-            if (temp[j] & (1<<i)) {
-							if(Size == 1)
-							{
-              ILI9341_Draw_Pixel(X+j, Y+i, Colour);
-							}
-							else
-							{
-							ILI9341_Draw_Rectangle(X+(j*Size), Y+(i*Size), Size, Size, Colour);
-							}
-            }
-        }
-    }
+	ILI9341_PROFILE_FUNCTION(Draw_Char);
+	ILI9341_Draw_Glyphs(&Character, 1, X, Y, Colour, Size, Background_Colour);
 }
 
 /*Draws an array of characters (fonts imported from fonts.h) at X,Y location with specified font colour, size and Background colour*/
@@ -282,9 +372,10 @@ void ILI9341_Draw_Char(char Character, uint8_t X, uint8_t Y, uint16_t Colour, ui
  * @brief Draws a text string on the ILI9341 display.
  * 
  * This function draws a text string starting at the specified (X, Y) coordinates
- * with the given text color, size, and background color. Each character in the 
- * string is drawn sequentially, and the X coordinate is incremented by the width 
- * of the character multiplied by the size for each character.
+ * with the given text color, size, and background color. The whole string is
+ * rendered row by row through one address window covering the text box, so
+ * there is no per-character command overhead. Text running past the right or
+ * bottom edge of the screen is clipped.
  * 
  * @param Text Pointer to the null-terminated string to be drawn.
  * @param X The X coordinate where the text drawing starts.
@@ -293,12 +384,63 @@ void ILI9341_Draw_Char(char Character, uint8_t X, uint8_t Y, uint16_t Colour, ui
  * @param Size The size multiplier for the text.
  * @param Background_Colour The background color of the text.
  */
-void ILI9341_Draw_Text(const char* Text, uint8_t X, uint8_t Y, uint16_t Colour, uint16_t Size, uint16_t Background_Colour)
+void ILI9341_Draw_Text(const char* Text, uint16_t X, uint16_t Y, uint16_t Colour, uint16_t Size, uint16_t Background_Colour)
 {
-    while (*Text) {
-        ILI9341_Draw_Char(*Text++, X, Y, Colour, Size, Background_Colour);
-        X += CHAR_WIDTH*Size;
-    }
+	ILI9341_PROFILE_FUNCTION(Draw_Text);
+	ILI9341_Draw_Glyphs(Text, strlen(Text), X, Y, Colour, Size, Background_Colour);
+}
+
+/*Draws a W x H block of pixels from an RGB565 image (flash or RAM) at X,Y location*/
+/**
+ * @brief  Draws a bitmap, or a sub-rectangle of a larger image, at any position.
+ * @param  X: Screen X of the top-left pixel, may be negative or past the edge.
+ * @param  Y: Screen Y of the top-left pixel, may be negative or past the edge.
+ * @param  Width: Width of the block in pixels.
+ * @param  Height: Height of the block in pixels.
+ * @param  Source: First pixel of the block (RGB565, high byte first). To draw a
+ *                 sub-rectangle of an image, point at its top-left pixel.
+ * @param  Stride: Width of the source image in pixels (Width for a packed bitmap).
+ * @retval None
+ * 
+ * The block is clipped to the screen and only the visible part is sent, through
+ * one address window, straight from Source by DMA: a row per request when the
+ * visible rows are not contiguous in the source, otherwise in maximum-length
+ * chunks. The call returns once the transfer is started, see
+ * ILI9341_Transmit_DMA_Rows; Source must stay valid until then. A Source in
+ * CCM RAM, which the DMA cannot read, is sent with blocking transfers.
+ */
+void ILI9341_Draw_Bitmap(int16_t X, int16_t Y, uint16_t Width, uint16_t Height, const uint8_t* Source, uint16_t Stride)
+{
+	ILI9341_PROFILE_FUNCTION(Draw_Bitmap);
+#if ILI9341_INDEXED
+	if(ILI9341_Get_Render_Mode() == ILI9341_RENDER_INDEXED)
+	{
+		ILI9341_Indexed_Draw_Bitmap(X, Y, Width, Height, Source, Stride);
+		return;
+	}
+#endif
+	int32_t x0 = X;
+	int32_t y0 = Y;
+	int32_t x1 = (int32_t)X + Width;
+	int32_t y1 = (int32_t)Y + Height;
+
+	//CLIP TO THE SCREEN
+	if(x0 < 0)
+	{
+		Source += (uint32_t)(-x0)*2;
+		x0 = 0;
+	}
+	if(y0 < 0)
+	{
+		Source += (uint32_t)(-y0)*Stride*2;
+		y0 = 0;
+	}
+	if(x1 > LCD_WIDTH) x1 = LCD_WIDTH;
+	if(y1 > LCD_HEIGHT) y1 = LCD_HEIGHT;
+	if((x0 >= x1) || (y0 >= y1)) return;
+
+	ILI9341_Set_Address(x0, y0, x1-1, y1-1);
+	ILI9341_Transmit_DMA_Rows(Source, (x1-x0)*2, y1-y0, (uint32_t)Stride*2);
 }
 
 /*Draws a full screen picture from flash. Image converted from RGB .jpeg/other to C array using online converter*/
@@ -308,7 +450,7 @@ void ILI9341_Draw_Text(const char* Text, uint8_t X, uint8_t Y, uint16_t Colour,
  * @brief Draws an image on the ILI9341 display with the specified orientation.
  * 
  * This function sets the rotation and address of the ILI9341 display based on the given orientation,
- * and then transmits the image data to the display using SPI.
+ * and then streams the image data to the display using DMA.
  * 
  * @param Image_Array Pointer to the image data array.
  * @param Orientation The orientation of the image on the display. 
@@ -321,98 +463,29 @@ void ILI9341_Draw_Text(const char* Text, uint8_t X, uint8_t Y, uint16_t Colour,
  * The function performs the following steps:
  * 1. Sets the display rotation based on the orientation.
  * 2. Sets the address window for the entire screen.
- * 3. Selects the display by setting the DC and CHIP_SELECT pins.
- * 4. Transmits the image data in chunks of BURST_MAX_SIZE using SPI.
- * 5. Deselects the display by resetting the CHIP_SELECT pin.
+ * 3. Starts a DMA transfer straight from the image array (flash or RAM), in
+ *    chunks of ILI9341_DMA_MAX_TRANSFER bytes, and returns.
+ * 
+ * The CPU is free while the 150 KB are on the wire. ILI9341_Transfer_Complete_Callback
+ * is called from the DMA interrupt when the last byte is sent, and
+ * ILI9341_Is_Busy() reports the same state for polling. Any other drawing call
+ * waits for the image to finish first.
  * 
  * Note: The image data array should contain pixel data in the format expected by the ILI9341 display.
  */
 void ILI9341_Draw_Image(const char* Image_Array, uint8_t Orientation)
 {
-	if(Orientation == SCREEN_HORIZONTAL_1)
-	{
-		ILI9341_Set_Rotation(SCREEN_HORIZONTAL_1);
-		ILI9341_Set_Address(0,0,ILI9341_SCREEN_WIDTH,ILI9341_SCREEN_HEIGHT);
-
-		HAL_GPIO_WritePin(DC_GPIO_Port, DC_Pin, GPIO_PIN_SET);
-		HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
-
-		unsigned char Temp_small_buffer[BURST_MAX_SIZE];
-		uint32_t counter = 0;
-		for(uint32_t i = 0; i < ILI9341_SCREEN_WIDTH*ILI9341_SCREEN_HEIGHT*2/BURST_MAX_SIZE; i++)
-		{
-				for(uint32_t k = 0; k< BURST_MAX_SIZE; k++)
-				{
-					Temp_small_buffer[k]	= Image_Array[counter+k];
-				}
-				HAL_SPI_Transmit(&hspi2, (unsigned char*)Temp_small_buffer, BURST_MAX_SIZE, 10);
-				counter += BURST_MAX_SIZE;
-		}
-		HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_SET);
-	}
-	else if(Orientation == SCREEN_HORIZONTAL_2)
-	{
-		ILI9341_Set_Rotation(SCREEN_HORIZONTAL_2);
-		ILI9341_Set_Address(0,0,ILI9341_SCREEN_WIDTH,ILI9341_SCREEN_HEIGHT);
-
-		HAL_GPIO_WritePin(DC_GPIO_Port, DC_Pin, GPIO_PIN_SET);
-		HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
+	ILI9341_PROFILE_FUNCTION(Draw_Image);
+	if(Orientation > SCREEN_HORIZONTAL_2) return;
 
-		unsigned char Temp_small_buffer[BURST_MAX_SIZE];
-		uint32_t counter = 0;
-		for(uint32_t i = 0; i < ILI9341_SCREEN_WIDTH*ILI9341_SCREEN_HEIGHT*2/BURST_MAX_SIZE; i++)
-		{
-				for(uint32_t k = 0; k< BURST_MAX_SIZE; k++)
-				{
-					Temp_small_buffer[k]	= Image_Array[counter+k];
-				}
-				HAL_SPI_Transmit(&hspi2, (unsigned char*)Temp_small_buffer, BURST_MAX_SIZE, 10);
-				counter += BURST_MAX_SIZE;
-		}
-		HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_SET);
-	}
-	else if(Orientation == SCREEN_VERTICAL_2)
+	ILI9341_Set_Rotation(Orientation);
+#if ILI9341_INDEXED
+	if(ILI9341_Get_Render_Mode() == ILI9341_RENDER_INDEXED)
 	{
-		ILI9341_Set_Rotation(SCREEN_VERTICAL_2);
-		ILI9341_Set_Address(0,0,ILI9341_SCREEN_HEIGHT,ILI9341_SCREEN_WIDTH);
-
-		HAL_GPIO_WritePin(DC_GPIO_Port, DC_Pin, GPIO_PIN_SET);
-		HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
-
-		unsigned char Temp_small_buffer[BURST_MAX_SIZE];
-		uint32_t counter = 0;
-		for(uint32_t i = 0; i < ILI9341_SCREEN_WIDTH*ILI9341_SCREEN_HEIGHT*2/BURST_MAX_SIZE; i++)
-		{
-				for(uint32_t k = 0; k< BURST_MAX_SIZE; k++)
-				{
-					Temp_small_buffer[k]	= Image_Array[counter+k];
-				}
-				HAL_SPI_Transmit(&hspi2, (unsigned char*)Temp_small_buffer, BURST_MAX_SIZE, 10);
-				counter += BURST_MAX_SIZE;
-		}
-		HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_SET);
-	}
-	else if(Orientation == SCREEN_VERTICAL_1)
-	{
-		ILI9341_Set_Rotation(SCREEN_VERTICAL_1);
-		ILI9341_Set_Address(0,0,ILI9341_SCREEN_HEIGHT,ILI9341_SCREEN_WIDTH);
-
-		HAL_GPIO_WritePin(DC_GPIO_Port, DC_Pin, GPIO_PIN_SET);
-		HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_RESET);
-
-		unsigned char Temp_small_buffer[BURST_MAX_SIZE];
-		uint32_t counter = 0;
-		for(uint32_t i = 0; i < ILI9341_SCREEN_WIDTH*ILI9341_SCREEN_HEIGHT*2/BURST_MAX_SIZE; i++)
-		{
-				for(uint32_t k = 0; k< BURST_MAX_SIZE; k++)
-				{
-					Temp_small_buffer[k]	= Image_Array[counter+k];
-				}
-				HAL_SPI_Transmit(&hspi2, (unsigned char*)Temp_small_buffer, BURST_MAX_SIZE, 10);
-				counter += BURST_MAX_SIZE;
-		}
-		HAL_GPIO_WritePin(CHIP_SELECT_GPIO_Port, CHIP_SELECT_Pin, GPIO_PIN_SET);
+		ILI9341_Indexed_Draw_Bitmap(0, 0, LCD_WIDTH, LCD_HEIGHT, (const uint8_t*)Image_Array, LCD_WIDTH);
+		return;
 	}
+#endif
+	ILI9341_Set_Address(0, 0, LCD_WIDTH-1, LCD_HEIGHT-1);
+	ILI9341_Transmit_DMA((const uint8_t*)Image_Array, ILI9341_SCREEN_WIDTH*ILI9341_SCREEN_HEIGHT*2);
 }
-
-
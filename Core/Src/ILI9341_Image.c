@@ -0,0 +1,439 @@
+/*
+ * ILI9341_Image.c
+ *
+ *  Created on: Nov 27, 2024
+ *      Author: ellis
+ */
+
+#include "ILI9341_Image.h"
+#include "ILI9341_GFX.h"
+#include "ILI9341_Profile.h"
+#include "ILI9341_Memory.h"
+#include "ILI9341_Indexed.h"
+
+/*
+ * ILI9341_IMAGE_QOI565 stream
+ *
+ * A QOI-style byte stream adapted to RGB565. The decoder keeps the previous
+ * pixel (black at the start) and a 64 entry table of recently seen colours,
+ * indexed by ILI9341_QOI_HASH. Every op produces one pixel, except RUN:
+ *
+ *   00iiiiii                     INDEX  pixel = table[i]
+ *   01rrggbb                     DIFF   r, g, b each change by -2..1 (stored +2)
+ *   10gggggg rrrrbbbb            LUMA   g changes by -32..31 (stored +32),
+ *                                       r and b by (dg >> 1) plus -8..7 (stored +8)
+ *   11nnnnnn                     RUN    previous pixel repeated n+1 times (n < 62)
+ *   11111110 hhhhhhhh llllllll   RGB    literal pixel, high byte first
+ *
+ * Channel arithmetic wraps (5 bits red and blue, 6 bits green). Every pixel
+ * not produced by RUN is stored in the table.
+ */
+#define ILI9341_QOI_OP_INDEX	0x00
+#define ILI9341_QOI_OP_DIFF		0x40
+#define ILI9341_QOI_OP_LUMA		0x80
+#define ILI9341_QOI_OP_RUN		0xC0
+#define ILI9341_QOI_OP_RGB		0xFE
+#define ILI9341_QOI_MASK		0xC0
+#define ILI9341_QOI_HASH(P)		((((P) >> 11)*3 + (((P) >> 5) & 0x3F)*5 + ((P) & 0x1F)*7) & 0x3F)
+
+typedef struct
+{
+	const uint8_t*	Data;		//next op
+	const uint8_t*	End;		//first byte after the stream, Data + Size of the image
+	uint8_t			Error;		//set when an op needed bytes past End
+	uint16_t		Pixel;		//last decoded pixel, native RGB565
+	uint8_t			Run;		//repeats of Pixel still to output
+	uint16_t		Index[64];
+} ILI9341_QOI_Decoder_TypeDef;
+
+static ILI9341_QOI_Decoder_TypeDef decoder ILI9341_CCMRAM;
+
+/*Palette expansion tables, rebuilt only when another palette is drawn or after ILI9341_Image_Invalidate_Palette*/
+static uint16_t			palette_lut[256] ILI9341_CCMRAM;			//palette entry in display byte order
+static uint32_t			palette_pair_lut[256] ILI9341_CCMRAM;		//INDEX4 byte -> both pixels, ready for one word store
+static const uint16_t*	lut_palette = NULL;
+static uint8_t			lut_format;
+
+/**
+ * @brief  Decodes the next pixels of a ILI9341_IMAGE_QOI565 stream.
+ * @param  Decoder: Decoder state.
+ * @param  Out: Destination, pixels in display byte order; NULL to skip them.
+ * @param  Count: Number of pixels to decode.
+ * @retval None
+ *
+ * Reads never go past Decoder->End: when the stream runs out, Decoder->Error
+ * is set and the call stops without writing the missing pixels.
+ */
+static ILI9341_RAMFUNC void ILI9341_QOI_Decode(ILI9341_QOI_Decoder_TypeDef* Decoder, uint16_t* Out, uint32_t Count)
+{
+	const uint8_t* data = Decoder->Data;
+	const uint8_t* end = Decoder->End;
+	uint16_t pixel = Decoder->Pixel;
+	uint8_t run = Decoder->Run;
+
+	while(Count--)
+	{
+		if(run != 0)
+		{
+			run--;
+		}
+		else
+		{
+			if(data >= end)
+			{
+				Decoder->Error = 1;
+				break;
+			}
+			uint8_t op = *data++;
+			if(op == ILI9341_QOI_OP_RGB)
+			{
+				if(end - data < 2)
+				{
+					Decoder->Error = 1;
+					break;
+				}
+				pixel = (data[0] << 8) | data[1];
+				data += 2;
+				Decoder->Index[ILI9341_QOI_HASH(pixel)] = pixel;
+			}
+			else if((op & ILI9341_QOI_MASK) == ILI9341_QOI_OP_RUN)
+			{
+				run = op & 0x3F;
+			}
+			else if((op & ILI9341_QOI_MASK) == ILI9341_QOI_OP_INDEX)
+			{
+				pixel = Decoder->Index[op];
+			}
+			else
+			{
+				int dr, dg, db;
+				if((op & ILI9341_QOI_MASK) == ILI9341_QOI_OP_DIFF)
+				{
+					dr = ((op >> 4) & 0x03) - 2;
+					dg = ((op >> 2) & 0x03) - 2;
+					db = (op & 0x03) - 2;
+				}
+				else
+				{
+					if(data >= end)
+					{
+						Decoder->Error = 1;
+						break;
+					}
+					uint8_t rb = *data++;
+					dg = (op & 0x3F) - 32;
+					dr = (dg >> 1) + (rb >> 4) - 8;
+					db = (dg >> 1) + (rb & 0x0F) - 8;
+				}
+				pixel = ((((pixel >> 11) + dr) & 0x1F) << 11)
+					  | ((((pixel >> 5) + dg) & 0x3F) << 5)
+					  | ((pixel + db) & 0x1F);
+				Decoder->Index[ILI9341_QOI_HASH(pixel)] = pixel;
+			}
+		}
+		if(Out != NULL)
+		{
+			*Out++ = (pixel >> 8) | (pixel << 8);
+		}
+	}
+
+	Decoder->Data = data;
+	Decoder->Pixel = pixel;
+	Decoder->Run = run;
+}
+
+/**
+ * @brief  Hands a decoded band of the back buffer on: to the panel, or into the indexed framebuffer.
+ * @param  X: Screen X of the band.
+ * @param  Y: Screen Y of the first row of the band.
+ * @param  Width: Pixels per row.
+ * @param  Rows: Rows in the band.
+ *
+ * In ILI9341_RENDER_INDEXED mode the band, already RGB565 in display byte
+ * order, is quantised into the framebuffer like any bitmap and the back
+ * buffer goes back to the pool unsent.
+ */
+static void ILI9341_Image_Send_Band(int32_t X, int32_t Y, uint16_t Width, uint16_t Rows)
+{
+#if ILI9341_INDEXED
+	if(ILI9341_Get_Render_Mode() == ILI9341_RENDER_INDEXED)
+	{
+		ILI9341_Indexed_Draw_Bitmap(X, Y, Width, Rows, ILI9341_Get_Back_Buffer(), Width);
+		ILI9341_Send_Back_Buffer(0);
+		return;
+	}
+#endif
+	ILI9341_Send_Back_Buffer((uint32_t)Rows*Width*2);
+}
+
+/**
+ * @brief  Draws a ILI9341_IMAGE_QOI565 image, decoding straight into the DMA buffers.
+ * @param  Image: Image descriptor.
+ * @param  X: Screen X of the top-left pixel, may be off screen.
+ * @param  Y: Screen Y of the top-left pixel, may be off screen.
+ * @retval ILI9341_IMAGE_OK, ILI9341_IMAGE_TRUNCATED when the stream ends
+ *         (Image->Size bytes) before the last visible pixel, or
+ *         ILI9341_IMAGE_NO_BUFFER.
+ *
+ * Whole rows of the visible part are decoded into the back buffer, which is
+ * then sent while the next band is decoded into the other buffer. Pixels left
+ * and right of the screen are decoded and dropped, rows below the screen are
+ * not decoded at all. No frame buffer is needed; in the indexed render mode
+ * the bands go into the 8bpp framebuffer instead. A truncated or corrupt
+ * stream stops at the last complete row.
+ */
+static uint8_t ILI9341_Image_Draw_QOI565(const ILI9341_Image_TypeDef* Image, int16_t X, int16_t Y)
+{
+	int32_t x0 = (X < 0) ? 0 : X;
+	int32_t y0 = (Y < 0) ? 0 : Y;
+	int32_t x1 = (int32_t)X + Image->Width;
+	int32_t y1 = (int32_t)Y + Image->Height;
+	if(x1 > LCD_WIDTH) x1 = LCD_WIDTH;
+	if(y1 > LCD_HEIGHT) y1 = LCD_HEIGHT;
+	if((x0 >= x1) || (y0 >= y1)) return ILI9341_IMAGE_OK;
+
+	uint16_t width = x1 - x0;
+	uint16_t skip_left = x0 - X;
+	uint16_t skip_right = Image->Width - width - skip_left;
+	uint16_t band_rows = ILI9341_DMA_BUFFER_SIZE / (width*2);
+
+	decoder.Data = Image->Data;
+	decoder.End = Image->Data + Image->Size;
+	decoder.Error = 0;
+	decoder.Pixel = 0;
+	decoder.Run = 0;
+	for(uint8_t i = 0; i < 64; i++)
+	{
+		decoder.Index[i] = 0;
+	}
+
+	//ROWS ABOVE THE SCREEN
+	ILI9341_QOI_Decode(&decoder, NULL, (uint32_t)(y0 - Y)*Image->Width);
+	if(decoder.Error) return ILI9341_IMAGE_TRUNCATED;
+	if(ILI9341_Get_Back_Buffer() == NULL) return ILI9341_IMAGE_NO_BUFFER;
+
+	ILI9341_Set_Address(x0, y0, x1-1, y1-1);		//only recorded in the indexed mode
+	for(int32_t row = y0; row < y1; row += band_rows)
+	{
+		uint16_t rows = (y1 - row < band_rows) ? y1 - row : band_rows;
+		uint16_t* pixel = (uint16_t*)ILI9341_Get_Back_Buffer();
+		for(uint16_t i = 0; i < rows; i++)
+		{
+			ILI9341_QOI_Decode(&decoder, NULL, skip_left);
+			ILI9341_QOI_Decode(&decoder, pixel, width);
+			ILI9341_QOI_Decode(&decoder, NULL, skip_right);
+			if(decoder.Error)
+			{
+				ILI9341_Image_Send_Band(x0, row, width, i);
+				return ILI9341_IMAGE_TRUNCATED;
+			}
+			pixel += width;
+		}
+		ILI9341_Image_Send_Band(x0, row, width, rows);
+	}
+	return ILI9341_IMAGE_OK;
+}
+
+/**
+ * @brief  Loads the expansion tables for a palette, unless they already hold it.
+ * @param  Image: INDEX8 or INDEX4 image.
+ */
+static void ILI9341_Load_Palette(const ILI9341_Image_TypeDef* Image)
+{
+	uint16_t entries = (Image->Format == ILI9341_IMAGE_INDEX8) ? 256 : 16;
+
+	if((lut_palette == Image->Palette) && (lut_format == Image->Format)) return;
+	for(uint16_t i = 0; i < entries; i++)
+	{
+		uint16_t colour = Image->Palette[i];
+		palette_lut[i] = (colour >> 8) | (colour << 8);
+	}
+	if(Image->Format == ILI9341_IMAGE_INDEX4)
+	{
+		//little endian: the first (high nibble) pixel goes in the low half-word
+		for(uint16_t i = 0; i < 256; i++)
+		{
+			palette_pair_lut[i] = palette_lut[i >> 4] | ((uint32_t)palette_lut[i & 0x0F] << 16);
+		}
+	}
+	lut_palette = Image->Palette;
+	lut_format = Image->Format;
+}
+
+/**
+ * @brief  Forgets the expanded palette, so the next INDEX8/INDEX4 draw rebuilds it.
+ * @retval None
+ *
+ * The expansion tables are reused while images keep pointing at the same
+ * palette array, and the contents are not compared. Call this after changing
+ * the entries of a palette in RAM, otherwise images drawn with it still show
+ * the old colours.
+ */
+void ILI9341_Image_Invalidate_Palette(void)
+{
+	ILI9341_PROFILE_FUNCTION(Image_Invalidate_Palette);
+	lut_palette = NULL;
+}
+
+/**
+ * @brief  Expands 8 bpp indices to display order RGB565, two pixels per word store.
+ * @param  Source: First index.
+ * @param  Out: Destination, half-word aligned.
+ * @param  Count: Number of pixels.
+ */
+static ILI9341_RAMFUNC void ILI9341_Expand_Index8(const uint8_t* Source, uint16_t* Out, uint16_t Count)
+{
+	if((((uintptr_t)Out & 0x02) != 0) && (Count != 0))
+	{
+		*Out++ = palette_lut[*Source++];
+		Count--;
+	}
+	uint32_t* out = (uint32_t*)Out;
+	for(; Count >= 4; Count -= 4)
+	{
+		out[0] = palette_lut[Source[0]] | ((uint32_t)palette_lut[Source[1]] << 16);
+		out[1] = palette_lut[Source[2]] | ((uint32_t)palette_lut[Source[3]] << 16);
+		Source += 4;
+		out += 2;
+	}
+	Out = (uint16_t*)out;
+	while(Count--)
+	{
+		*Out++ = palette_lut[*Source++];
+	}
+}
+
+/**
+ * @brief  Expands 4 bpp indices to display order RGB565, one byte lookup per two pixels.
+ * @param  Row: First byte of the source row.
+ * @param  First: First pixel of the row to expand.
+ * @param  Out: Destination, half-word aligned.
+ * @param  Count: Number of pixels.
+ */
+static ILI9341_RAMFUNC void ILI9341_Expand_Index4(const uint8_t* Row, uint16_t First, uint16_t* Out, uint16_t Count)
+{
+	const uint8_t* source = Row + First/2;
+
+	if(((First & 1) != 0) && (Count != 0))
+	{
+		*Out++ = palette_lut[*source++ & 0x0F];
+		Count--;
+	}
+	if(((uintptr_t)Out & 0x02) == 0)
+	{
+		uint32_t* out = (uint32_t*)Out;
+		for(; Count >= 2; Count -= 2)
+		{
+			*out++ = palette_pair_lut[*source++];
+		}
+		Out = (uint16_t*)out;
+	}
+	else
+	{
+		for(; Count >= 2; Count -= 2)
+		{
+			uint32_t pair = palette_pair_lut[*source++];
+			*Out++ = pair;
+			*Out++ = pair >> 16;
+		}
+	}
+	if(Count != 0)
+	{
+		*Out = palette_lut[*source >> 4];
+	}
+}
+
+/**
+ * @brief  Draws an INDEX8 or INDEX4 image, expanding the palette into the DMA buffers.
+ * @param  Image: Image descriptor.
+ * @param  X: Screen X of the top-left pixel, may be off screen.
+ * @param  Y: Screen Y of the top-left pixel, may be off screen.
+ * @retval ILI9341_IMAGE_OK or ILI9341_IMAGE_NO_BUFFER.
+ *
+ * Only the visible part is read from the source. Bands of rows are expanded
+ * into the back buffer while the previous band is sent, or quantised into the
+ * framebuffer in the indexed render mode.
+ */
+static uint8_t ILI9341_Image_Draw_Indexed(const ILI9341_Image_TypeDef* Image, int16_t X, int16_t Y)
+{
+	int32_t x0 = (X < 0) ? 0 : X;
+	int32_t y0 = (Y < 0) ? 0 : Y;
+	int32_t x1 = (int32_t)X + Image->Width;
+	int32_t y1 = (int32_t)Y + Image->Height;
+	if(x1 > LCD_WIDTH) x1 = LCD_WIDTH;
+	if(y1 > LCD_HEIGHT) y1 = LCD_HEIGHT;
+	if((x0 >= x1) || (y0 >= y1)) return ILI9341_IMAGE_OK;
+
+	uint16_t width = x1 - x0;
+	uint16_t first = x0 - X;
+	uint16_t band_rows = ILI9341_DMA_BUFFER_SIZE / (width*2);
+	uint32_t stride = (Image->Format == ILI9341_IMAGE_INDEX8) ? Image->Width : (Image->Width + 1)/2;
+	const uint8_t* row_data = Image->Data + (uint32_t)(y0 - Y)*stride;
+
+	if(ILI9341_Get_Back_Buffer() == NULL) return ILI9341_IMAGE_NO_BUFFER;
+	ILI9341_Load_Palette(Image);
+	ILI9341_Set_Address(x0, y0, x1-1, y1-1);		//only recorded in the indexed mode
+	for(int32_t row = y0; row < y1; row += band_rows)
+	{
+		uint16_t rows = (y1 - row < band_rows) ? y1 - row : band_rows;
+		uint16_t* pixel = (uint16_t*)ILI9341_Get_Back_Buffer();
+		for(uint16_t i = 0; i < rows; i++)
+		{
+			if(Image->Format == ILI9341_IMAGE_INDEX8)
+			{
+				ILI9341_Expand_Index8(row_data + first, pixel, width);
+			}
+			else
+			{
+				ILI9341_Expand_Index4(row_data, first, pixel, width);
+			}
+			row_data += stride;
+			pixel += width;
+		}
+		ILI9341_Image_Send_Band(x0, row, width, rows);
+	}
+	return ILI9341_IMAGE_OK;
+}
+
+/*Draws an image asset at X,Y location*/
+/**
+ * @brief  Draws an image described by a ILI9341_Image_TypeDef at any position.
+ * @param  Image: Image descriptor.
+ * @param  X: Screen X of the top-left pixel, may be off screen.
+ * @param  Y: Screen Y of the top-left pixel, may be off screen.
+ * @retval ILI9341_IMAGE_OK, ILI9341_IMAGE_TRUNCATED when Image->Size bytes do
+ *         not hold the whole image (nothing past Data + Size is read),
+ *         ILI9341_IMAGE_NO_BUFFER when the application holds every transfer
+ *         buffer, or ILI9341_IMAGE_BAD_FORMAT.
+ *
+ * The image is clipped to the screen. Raw images are streamed by DMA straight
+ * from their source, compressed and palettised ones are decoded on the fly
+ * into the transfer buffers. In all cases the call returns while the last
+ * part is still being sent. In the indexed render mode every format is
+ * quantised into the 8bpp framebuffer and sent by ILI9341_Indexed_Flush.
+ */
+uint8_t ILI9341_Image_Draw(const ILI9341_Image_TypeDef* Image, int16_t X, int16_t Y)
+{
+	ILI9341_PROFILE_FUNCTION(Image_Draw);
+	switch(Image->Format)
+	{
+		case ILI9341_IMAGE_RGB565:
+			if(Image->Size < (uint32_t)Image->Width*Image->Height*2) return ILI9341_IMAGE_TRUNCATED;
+			ILI9341_Draw_Bitmap(X, Y, Image->Width, Image->Height, Image->Data, Image->Width);
+			return ILI9341_IMAGE_OK;
+
+		case ILI9341_IMAGE_QOI565:
+			return ILI9341_Image_Draw_QOI565(Image, X, Y);
+
+		case ILI9341_IMAGE_INDEX8:
+			if(Image->Size < (uint32_t)Image->Width*Image->Height) return ILI9341_IMAGE_TRUNCATED;
+			return ILI9341_Image_Draw_Indexed(Image, X, Y);
+
+		case ILI9341_IMAGE_INDEX4:
+			if(Image->Size < (uint32_t)(Image->Width + 1)/2*Image->Height) return ILI9341_IMAGE_TRUNCATED;
+			return ILI9341_Image_Draw_Indexed(Image, X, Y);
+
+		default:
+			return ILI9341_IMAGE_BAD_FORMAT;
+	}
+}
@@ -0,0 +1,36 @@
+/*
+ * ILI9341_Image.h
+ *
+ *  Created on: Nov 27, 2024
+ *      Author: ellis
+ */
+
+#ifndef SRC_ILI9341_IMAGE_H_
+#define SRC_ILI9341_IMAGE_H_
+
+#include "ILI9341.h"
+
+#define ILI9341_IMAGE_RGB565		0		//raw RGB565, high byte first (display order)
+#define ILI9341_IMAGE_QOI565		1		//compressed RGB565 op stream, see ILI9341_Image.c
+#define ILI9341_IMAGE_INDEX8		2		//8 bpp palette indices
+#define ILI9341_IMAGE_INDEX4		3		//4 bpp palette indices, high nibble first, rows start on a byte boundary
+
+#define ILI9341_IMAGE_OK			0		//whole image drawn (or clipped away)
+#define ILI9341_IMAGE_TRUNCATED		1		//Data ran out before the last pixel, the rows decoded so far are drawn
+#define ILI9341_IMAGE_BAD_FORMAT	2		//unknown Format, nothing drawn
+#define ILI9341_IMAGE_NO_BUFFER		3		//the application holds every transfer buffer, nothing drawn
+
+typedef struct
+{
+	uint16_t		Width;
+	uint16_t		Height;
+	uint8_t			Format;		//ILI9341_IMAGE_xxx
+	uint32_t		Size;		//bytes in Data
+	const uint8_t*	Data;
+	const uint16_t*	Palette;	//RGB565 colours of the INDEX formats, NULL otherwise
+} ILI9341_Image_TypeDef;
+
+uint8_t ILI9341_Image_Draw(const ILI9341_Image_TypeDef* Image, int16_t X, int16_t Y);
+void ILI9341_Image_Invalidate_Palette(void);
+
+#endif /* SRC_ILI9341_IMAGE_H_ */
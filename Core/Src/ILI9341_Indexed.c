@@ -0,0 +1,431 @@
+/*
+ * ILI9341_Indexed.c
+ *
+ *  Created on: Nov 27, 2024
+ *      Author: ellis
+ *
+ *  8bpp indexed render mode, compiled in with ILI9341_INDEXED. A whole
+ *  screen of palette indices (76.8 KB) fits in SRAM where RGB565 (150 KB)
+ *  does not. After ILI9341_Set_Render_Mode(ILI9341_RENDER_INDEXED) the
+ *  drawing calls of ILI9341.h and ILI9341_GFX.h write into the framebuffer
+ *  with no bus traffic, their colour arguments taking a palette index in the
+ *  low byte (ILI9341_INDEX converts RGB565 for the default palette). RGB565
+ *  bitmaps and images are quantised to the default palette.
+ *
+ *  Every write marks the span it touched in its row. ILI9341_Indexed_Flush
+ *  sends each run of consecutive dirty rows through one address window,
+ *  expanding the indices through the 256-entry palette into the transfer
+ *  buffers. Changing palette entries marks the whole screen dirty, so
+ *  palette animation costs one flush and no redrawing.
+ *
+ *  ILI9341_Image_Draw decodes into the framebuffer too.
+ *  ILI9341_Set_Address only records a window here, which
+ *  ILI9341_Draw_Colour/ILI9341_Draw_Colour_Burst then fill. Only the
+ *  transport calls (Transmit_DMA, Send_Buffer...) and ILI9341_Set_Panel_Address
+ *  always go to the panel. The framebuffer is laid out for
+ *  the rotation in use when it is drawn; redraw everything after
+ *  ILI9341_Set_Rotation.
+ */
+
+#include <string.h>
+#include "ILI9341_Indexed.h"
+#include "ILI9341_Profile.h"
+#include "ILI9341_Memory.h"
+#include "5x5_font.h"
+
+#if ILI9341_INDEXED
+
+static uint8_t indexed_frame[ILI9341_SCREEN_WIDTH*ILI9341_SCREEN_HEIGHT];
+static uint16_t indexed_palette[256] ILI9341_CCMRAM;			//display byte order
+static uint16_t dirty_x0[ILI9341_SCREEN_WIDTH] ILI9341_CCMRAM;	//dirty span per row, clean when x0 > x1
+static uint16_t dirty_x1[ILI9341_SCREEN_WIDTH] ILI9341_CCMRAM;
+static uint8_t render_mode = ILI9341_RENDER_DIRECT;
+static uint8_t indexed_ready = 0;		//spans cleaned and palette loaded, see ILI9341_Indexed_Start
+static uint16_t window_x1, window_y1, window_x2, window_y2;	//last ILI9341_Set_Address in this mode
+static uint32_t window_offset;			//next pixel of the window, like the panel write pointer
+static ILI9341_Indexed_Stats_TypeDef indexed_stats;
+
+/**
+ * @brief  First use of the framebuffer: every row clean, then the default palette.
+ *
+ * The span arrays sit in zero-filled memory, where every row would read as
+ * a dirty span [0,0]. Loading the palette then marks the whole (black)
+ * framebuffer dirty so the first flush clears the panel.
+ */
+static void ILI9341_Indexed_Start(void)
+{
+	for(uint16_t y = 0; y < ILI9341_SCREEN_WIDTH; y++)
+	{
+		dirty_x0[y] = UINT16_MAX;
+		dirty_x1[y] = 0;
+	}
+	indexed_ready = 1;
+	ILI9341_Indexed_Reset_Palette();
+}
+
+/**
+ * @brief  Marks columns X0..X1 of rows Y0..Y1 dirty, coordinates already on screen.
+ */
+static void ILI9341_Indexed_Mark(uint16_t X0, uint16_t Y0, uint16_t X1, uint16_t Y1)
+{
+	if(!indexed_ready) ILI9341_Indexed_Start();
+	for(uint16_t y = Y0; y <= Y1; y++)
+	{
+		if(X0 < dirty_x0[y]) dirty_x0[y] = X0;
+		if(X1 > dirty_x1[y]) dirty_x1[y] = X1;
+	}
+}
+
+/**
+ * @brief  Selects where the drawing calls render.
+ * @param  Mode: ILI9341_RENDER_DIRECT or ILI9341_RENDER_INDEXED.
+ * @retval None
+ *
+ * The first switch to the indexed mode cleans every row and loads the default
+ * palette, which marks the whole (black) framebuffer dirty. Switching back
+ * and forth keeps the framebuffer and its dirty rows.
+ */
+void ILI9341_Set_Render_Mode(uint8_t Mode)
+{
+	ILI9341_PROFILE_FUNCTION(Set_Render_Mode);
+	if(!indexed_ready) ILI9341_Indexed_Start();
+	render_mode = Mode;
+}
+
+/**
+ * @brief  Returns ILI9341_RENDER_DIRECT or ILI9341_RENDER_INDEXED.
+ */
+uint8_t ILI9341_Get_Render_Mode(void)
+{
+	return render_mode;
+}
+
+/**
+ * @brief  Replaces palette entries and marks the whole screen dirty.
+ * @param  First: First entry to replace.
+ * @param  Count: Number of entries, First + Count must not exceed 256.
+ * @param  Colours: RGB565 colours.
+ * @retval None
+ */
+void ILI9341_Indexed_Set_Palette(uint8_t First, uint16_t Count, const uint16_t* Colours)
+{
+	ILI9341_PROFILE_FUNCTION(Indexed_Set_Palette);
+	if(!indexed_ready) ILI9341_Indexed_Start();
+	for(uint16_t i = 0; (i < Count) && (First + i < 256); i++)
+	{
+		indexed_palette[First + i] = (Colours[i] >> 8) | (Colours[i] << 8);
+	}
+	ILI9341_Indexed_Mark(0, 0, LCD_WIDTH - 1, LCD_HEIGHT - 1);
+}
+
+/**
+ * @brief  Loads the default RGB332 palette, where entry ILI9341_INDEX(Colour) is closest to Colour.
+ * @retval None
+ */
+void ILI9341_Indexed_Reset_Palette(void)
+{
+	ILI9341_PROFILE_FUNCTION(Indexed_Reset_Palette);
+	for(uint16_t i = 0; i < 256; i++)
+	{
+		uint16_t red = (i >> 5) * 31 / 7;
+		uint16_t green = ((i >> 2) & 0x07) * 63 / 7;
+		uint16_t blue = (i & 0x03) * 31 / 3;
+		uint16_t colour = (red << 11) | (green << 5) | blue;
+		indexed_palette[i] = (colour >> 8) | (colour << 8);
+	}
+	ILI9341_Indexed_Mark(0, 0, LCD_WIDTH - 1, LCD_HEIGHT - 1);
+}
+
+/**
+ * @brief  Returns the framebuffer, LCD_HEIGHT rows of LCD_WIDTH indices.
+ * @retval Framebuffer; call ILI9341_Indexed_Invalidate for the areas written directly.
+ */
+uint8_t* ILI9341_Indexed_Get_Buffer(void)
+{
+	return indexed_frame;
+}
+
+/**
+ * @brief  Marks an area for the next flush.
+ * @param  X: Left edge, may be off screen.
+ * @param  Y: Top edge, may be off screen.
+ * @param  Width: Width of the area.
+ * @param  Height: Height of the area.
+ * @retval None
+ */
+void ILI9341_Indexed_Invalidate(int16_t X, int16_t Y, uint16_t Width, uint16_t Height)
+{
+	ILI9341_PROFILE_FUNCTION(Indexed_Invalidate);
+	int32_t x0 = (X < 0) ? 0 : X;
+	int32_t y0 = (Y < 0) ? 0 : Y;
+	int32_t x1 = (int32_t)X + Width - 1;
+	int32_t y1 = (int32_t)Y + Height - 1;
+
+	if(x1 >= LCD_WIDTH) x1 = LCD_WIDTH - 1;
+	if(y1 >= LCD_HEIGHT) y1 = LCD_HEIGHT - 1;
+	if((x0 > x1) || (y0 > y1)) return;
+	ILI9341_Indexed_Mark(x0, y0, x1, y1);
+}
+
+/**
+ * @brief  Fills a rectangle of the framebuffer, clipped to the screen.
+ * @param  X: Left edge, may be off screen.
+ * @param  Y: Top edge, may be off screen.
+ * @param  Width: Width in pixels.
+ * @param  Height: Height in pixels.
+ * @param  Index: Palette index.
+ * @retval None
+ */
+ILI9341_RAMFUNC void ILI9341_Indexed_Fill_Rect(int16_t X, int16_t Y, uint16_t Width, uint16_t Height, uint8_t Index)
+{
+	ILI9341_PROFILE_FUNCTION(Indexed_Fill_Rect);
+	int32_t x0 = (X < 0) ? 0 : X;
+	int32_t y0 = (Y < 0) ? 0 : Y;
+	int32_t x1 = (int32_t)X + Width - 1;
+	int32_t y1 = (int32_t)Y + Height - 1;
+
+	if(x1 >= LCD_WIDTH) x1 = LCD_WIDTH - 1;
+	if(y1 >= LCD_HEIGHT) y1 = LCD_HEIGHT - 1;
+	if((x0 > x1) || (y0 > y1)) return;
+
+	for(int32_t y = y0; y <= y1; y++)
+	{
+		memset(&indexed_frame[y*LCD_WIDTH + x0], Index, x1 - x0 + 1);
+	}
+	ILI9341_Indexed_Mark(x0, y0, x1, y1);
+}
+
+/**
+ * @brief  Records the address window for ILI9341_Indexed_Fill_Window, no bus traffic.
+ * @param  X1: Left column of the window.
+ * @param  Y1: Top row of the window.
+ * @param  X2: Right column of the window.
+ * @param  Y2: Bottom row of the window.
+ * @retval None
+ *
+ * Stands in for ILI9341_Set_Address; the write pointer goes back to the
+ * window start.
+ */
+void ILI9341_Indexed_Set_Window(uint16_t X1, uint16_t Y1, uint16_t X2, uint16_t Y2)
+{
+	window_x1 = X1;
+	window_y1 = Y1;
+	window_x2 = X2;
+	window_y2 = Y2;
+	window_offset = 0;
+}
+
+/**
+ * @brief  Fills pixels of the recorded window the way the panel writes them, row by row.
+ * @param  Count: Number of pixels, wrapping back to the window start like the panel.
+ * @param  Index: Palette index.
+ * @retval None
+ *
+ * Stands in for ILI9341_Draw_Colour_Burst: starts where the previous fill of
+ * the same window stopped. Parts of the window off the screen are dropped.
+ */
+void ILI9341_Indexed_Fill_Window(uint32_t Count, uint8_t Index)
+{
+	if((window_x2 < window_x1) || (window_y2 < window_y1)) return;
+
+	uint16_t width = window_x2 - window_x1 + 1;
+	uint32_t area = (uint32_t)width*(window_y2 - window_y1 + 1);
+	uint32_t offset = window_offset;
+
+	window_offset = (uint32_t)(((uint64_t)offset + Count) % area);
+	if(Count > area) Count = area;		//later passes overwrite with the same index
+	while(Count != 0)
+	{
+		uint16_t row = offset / width;
+		uint16_t column = offset % width;
+		uint32_t run = width - column;
+		if(run > Count) run = Count;
+		if((window_x1 + column < LCD_WIDTH) && (window_y1 + row < LCD_HEIGHT))
+		{
+			ILI9341_Indexed_Fill_Rect(window_x1 + column, window_y1 + row, run, 1, Index);
+		}
+		offset = (offset + run) % area;
+		Count -= run;
+	}
+}
+
+/**
+ * @brief  Sets scattered pixels, off-screen points are skipped.
+ * @param  Points: Pixel coordinates.
+ * @param  Count: Number of points.
+ * @param  Index: Palette index.
+ * @retval None
+ */
+ILI9341_RAMFUNC void ILI9341_Indexed_Draw_Pixels(const ILI9341_Point_TypeDef* Points, uint32_t Count, uint8_t Index)
+{
+	ILI9341_PROFILE_FUNCTION(Indexed_Draw_Pixels);
+	if(!indexed_ready) ILI9341_Indexed_Start();
+	for(uint32_t i = 0; i < Count; i++)
+	{
+		uint16_t x = Points[i].X;
+		uint16_t y = Points[i].Y;
+		if((x >= LCD_WIDTH) || (y >= LCD_HEIGHT)) continue;
+		indexed_frame[y*LCD_WIDTH + x] = Index;
+		if(x < dirty_x0[y]) dirty_x0[y] = x;
+		if(x > dirty_x1[y]) dirty_x1[y] = x;
+	}
+}
+
+/**
+ * @brief  Renders a run of characters, same text box and clipping as ILI9341_Draw_Text.
+ * @param  Text: Characters to draw, Count of them.
+ * @param  Count: Number of characters.
+ * @param  X: Left edge of the first character.
+ * @param  Y: Top edge of the first character.
+ * @param  Index: Palette index of the glyphs.
+ * @param  Size: Scale factor.
+ * @param  Background_Index: Palette index of the rest of the text box.
+ * @retval None
+ */
+ILI9341_RAMFUNC void ILI9341_Indexed_Draw_Glyphs(const char* Text, uint16_t Count, uint16_t X, uint16_t Y, uint8_t Index, uint16_t Size, uint8_t Background_Index)
+{
+	ILI9341_PROFILE_FUNCTION(Indexed_Draw_Glyphs);
+	if((Count == 0) || (Size == 0) || (X >= LCD_WIDTH) || (Y >= LCD_HEIGHT)) return;
+
+	uint32_t box_width = (uint32_t)Count*CHAR_WIDTH*Size;
+	uint32_t box_height = (uint32_t)CHAR_HEIGHT*Size;
+	uint16_t width = (X + box_width > LCD_WIDTH) ? (uint32_t)(LCD_WIDTH - X) : box_width;
+	uint16_t height = (Y + box_height > LCD_HEIGHT) ? (uint32_t)(LCD_HEIGHT - Y) : box_height;
+
+	for(uint16_t i = 0; i < height; i++)
+	{
+		uint8_t bit = 1 << (i / Size);
+		uint8_t* pixel = &indexed_frame[(Y + i)*LCD_WIDTH + X];
+		uint16_t remaining = width;
+		for(uint16_t c = 0; remaining != 0; c++)
+		{
+			uint8_t function_char = Text[c];
+			if((function_char < ' ') || (function_char > '~' + 1)) {
+				function_char = 0;
+			} else {
+				function_char -= 32;
+			}
+			const unsigned char* glyph = font[function_char];
+			for(uint8_t k = 0; (k < CHAR_WIDTH) && (remaining != 0); k++)
+			{
+				uint16_t repeat = (Size < remaining) ? Size : remaining;
+				memset(pixel, (glyph[k] & bit) ? Index : Background_Index, repeat);
+				pixel += repeat;
+				remaining -= repeat;
+			}
+		}
+	}
+	ILI9341_Indexed_Mark(X, Y, X + width - 1, Y + height - 1);
+}
+
+/**
+ * @brief  Copies an RGB565 bitmap into the framebuffer, quantised to the default palette.
+ * @param  X: Left edge, may be off screen.
+ * @param  Y: Top edge, may be off screen.
+ * @param  Width: Width in pixels.
+ * @param  Height: Height in pixels.
+ * @param  Source: First pixel, RGB565 high byte first.
+ * @param  Stride: Width of the source image in pixels.
+ * @retval None
+ */
+void ILI9341_Indexed_Draw_Bitmap(int16_t X, int16_t Y, uint16_t Width, uint16_t Height, const uint8_t* Source, uint16_t Stride)
+{
+	ILI9341_PROFILE_FUNCTION(Indexed_Draw_Bitmap);
+	int32_t x0 = (X < 0) ? 0 : X;
+	int32_t y0 = (Y < 0) ? 0 : Y;
+	int32_t x1 = (int32_t)X + Width - 1;
+	int32_t y1 = (int32_t)Y + Height - 1;
+
+	if(x1 >= LCD_WIDTH) x1 = LCD_WIDTH - 1;
+	if(y1 >= LCD_HEIGHT) y1 = LCD_HEIGHT - 1;
+	if((x0 > x1) || (y0 > y1)) return;
+
+	for(int32_t y = y0; y <= y1; y++)
+	{
+		const uint8_t* source = Source + ((uint32_t)(y - Y)*Stride + (x0 - X))*2;
+		uint8_t* pixel = &indexed_frame[y*LCD_WIDTH + x0];
+		for(int32_t x = x0; x <= x1; x++)
+		{
+			uint16_t colour = (source[0] << 8) | source[1];
+			*pixel++ = ILI9341_INDEX(colour);
+			source += 2;
+		}
+	}
+	ILI9341_Indexed_Mark(x0, y0, x1, y1);
+}
+
+/**
+ * @brief  Sends the dirty rows of the framebuffer and marks them clean.
+ * @retval None
+ *
+ * A run of consecutive dirty rows goes out through one address window as
+ * wide as the union of their spans. Rows are expanded through the palette
+ * into the DMA back buffer while the previous buffer is on the bus. Returns
+ * when the last row has been sent. When the application holds every
+ * transfer buffer nothing is sent and the rows stay dirty for the next flush.
+ */
+ILI9341_RAMFUNC void ILI9341_Indexed_Flush(void)
+{
+	ILI9341_PROFILE_FUNCTION(Indexed_Flush);
+	uint16_t y = 0;
+	uint8_t sent = 0;
+
+	if(!indexed_ready) ILI9341_Indexed_Start();
+	ILI9341_Begin_Write();
+	while(y < LCD_HEIGHT)
+	{
+		if(dirty_x0[y] > dirty_x1[y])
+		{
+			y++;
+			continue;
+		}
+
+		uint16_t y0 = y;
+		uint16_t x0 = dirty_x0[y];
+		uint16_t x1 = dirty_x1[y];
+		while((++y < LCD_HEIGHT) && (dirty_x0[y] <= dirty_x1[y]))
+		{
+			if(dirty_x0[y] < x0) x0 = dirty_x0[y];
+			if(dirty_x1[y] > x1) x1 = dirty_x1[y];
+		}
+
+		uint16_t width = x1 - x0 + 1;
+		uint16_t band_rows = ILI9341_DMA_BUFFER_SIZE / (width*2);
+		if(ILI9341_Get_Back_Buffer() == NULL) break;
+		ILI9341_Set_Panel_Address(x0, y0, x1, y - 1);
+		for(uint16_t row = y0; row < y; row += band_rows)
+		{
+			uint16_t rows = (y - row < band_rows) ? y - row : band_rows;
+			uint16_t* pixel = (uint16_t*)ILI9341_Get_Back_Buffer();
+			for(uint16_t i = row; i < row + rows; i++)
+			{
+				const uint8_t* index = &indexed_frame[i*LCD_WIDTH + x0];
+				for(uint16_t x = 0; x < width; x++)
+				{
+					*pixel++ = indexed_palette[*index++];
+				}
+				dirty_x0[i] = UINT16_MAX;
+				dirty_x1[i] = 0;
+			}
+			ILI9341_Send_Back_Buffer(rows*width*2);
+		}
+		indexed_stats.Windows++;
+		indexed_stats.Rows += y - y0;
+		indexed_stats.Pixels += (uint32_t)width*(y - y0);
+		sent = 1;
+	}
+	ILI9341_End_Write();
+	indexed_stats.Flushes += sent;
+}
+
+/**
+ * @brief  Copies the flush counters, cumulative since start-up.
+ * @param  Stats: Destination.
+ * @retval None
+ */
+void ILI9341_Indexed_Get_Stats(ILI9341_Indexed_Stats_TypeDef* Stats)
+{
+	*Stats = indexed_stats;
+}
+
+#endif /* ILI9341_INDEXED */
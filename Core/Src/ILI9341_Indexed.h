@@ -0,0 +1,53 @@
+/*
+ * ILI9341_Indexed.h
+ *
+ *  Created on: Nov 27, 2024
+ *      Author: ellis
+ */
+
+#ifndef SRC_ILI9341_INDEXED_H_
+#define SRC_ILI9341_INDEXED_H_
+
+#include "ILI9341.h"
+
+#define ILI9341_RENDER_DIRECT		0		//drawing calls go straight to the panel
+#define ILI9341_RENDER_INDEXED		1		//drawing calls go to the 8bpp framebuffer, sent by ILI9341_Indexed_Flush
+
+/*RGB565 colour to its index in the default (RGB332) palette*/
+#define ILI9341_INDEX(Colour)		((uint8_t)((((Colour) >> 8) & 0xE0) | (((Colour) >> 6) & 0x1C) | (((Colour) >> 3) & 0x03)))
+
+/*Whether drawing calls go to the panel, i.e. not into the indexed framebuffer*/
+#if ILI9341_INDEXED
+#define ILI9341_RENDERS_TO_PANEL()	(ILI9341_Get_Render_Mode() == ILI9341_RENDER_DIRECT)
+#else
+#define ILI9341_RENDERS_TO_PANEL()	1
+#endif
+
+#if ILI9341_INDEXED
+
+typedef struct
+{
+	uint32_t Flushes;			//ILI9341_Indexed_Flush calls that sent something
+	uint32_t Windows;			//address windows sent
+	uint32_t Rows;				//framebuffer rows sent
+	uint32_t Pixels;			//pixels expanded and sent
+} ILI9341_Indexed_Stats_TypeDef;
+
+void ILI9341_Set_Render_Mode(uint8_t Mode);
+uint8_t ILI9341_Get_Render_Mode(void);
+void ILI9341_Indexed_Set_Palette(uint8_t First, uint16_t Count, const uint16_t* Colours);
+void ILI9341_Indexed_Reset_Palette(void);
+uint8_t* ILI9341_Indexed_Get_Buffer(void);
+void ILI9341_Indexed_Invalidate(int16_t X, int16_t Y, uint16_t Width, uint16_t Height);
+void ILI9341_Indexed_Fill_Rect(int16_t X, int16_t Y, uint16_t Width, uint16_t Height, uint8_t Index);
+void ILI9341_Indexed_Set_Window(uint16_t X1, uint16_t Y1, uint16_t X2, uint16_t Y2);
+void ILI9341_Indexed_Fill_Window(uint32_t Count, uint8_t Index);
+void ILI9341_Indexed_Draw_Pixels(const ILI9341_Point_TypeDef* Points, uint32_t Count, uint8_t Index);
+void ILI9341_Indexed_Draw_Glyphs(const char* Text, uint16_t Count, uint16_t X, uint16_t Y, uint8_t Index, uint16_t Size, uint8_t Background_Index);
+void ILI9341_Indexed_Draw_Bitmap(int16_t X, int16_t Y, uint16_t Width, uint16_t Height, const uint8_t* Source, uint16_t Stride);
+void ILI9341_Indexed_Flush(void);
+void ILI9341_Indexed_Get_Stats(ILI9341_Indexed_Stats_TypeDef* Stats);
+
+#endif /* ILI9341_INDEXED */
+
+#endif /* SRC_ILI9341_INDEXED_H_ */
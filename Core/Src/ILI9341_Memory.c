@@ -0,0 +1,126 @@
+/*
+ * ILI9341_Memory.c
+ *
+ *  Created on: Nov 27, 2024
+ *      Author: ellis
+ *
+ *  Region-aware scratch pools. CPU-only working sets (span and sort tables,
+ *  decoder state, display lists, glyph caches) are taken from a pool in CCM
+ *  RAM; buffers the DMA sends are taken from a pool in SRAM. Both are stack
+ *  allocators: take a mark, allocate, release back to the mark when done,
+ *
+ *    uint32_t mark = ILI9341_Mem_Mark(ILI9341_MEM_CPU);
+ *    uint16_t* spans = ILI9341_Mem_Alloc(ILI9341_MEM_CPU, 240*4);
+ *    ...
+ *    ILI9341_Mem_Release(ILI9341_MEM_CPU, mark);
+ *
+ *  so there is no fragmentation and no heap. A mark carries its region, so a
+ *  mark from the other pool, or one above the current top (stale, its
+ *  allocations already released), is refused instead of moving the top.
+ *  Allocations are 4-byte aligned
+ *  and not cleared. The driver's own fixed tables are placed statically with
+ *  ILI9341_CCMRAM / ILI9341_DMA_RAM instead, so both pools are for the
+ *  application and cost nothing until ILI9341_MEM_CPU_SIZE / _DMA_SIZE are set;
+ *  an empty pool refuses every allocation.
+ */
+
+#include "ILI9341_Memory.h"
+
+#define ILI9341_MEM_MARK_TAG(Region)	((uint32_t)((Region) + 1) << 24)	//pools are below 16 MB
+#define ILI9341_MEM_MARK_OFFSET			0x00FFFFFFUL
+
+#if ILI9341_MEM_CPU_SIZE > 0
+static uint8_t mem_cpu_pool[ILI9341_MEM_CPU_SIZE] ILI9341_CCMRAM __attribute__((aligned(4)));
+#else
+#define mem_cpu_pool				NULL
+#endif
+#if ILI9341_MEM_DMA_SIZE > 0
+static uint8_t mem_dma_pool[ILI9341_MEM_DMA_SIZE] ILI9341_DMA_RAM;
+#else
+#define mem_dma_pool				NULL
+#endif
+
+static uint8_t* const mem_pool[ILI9341_MEM_REGIONS] = {mem_cpu_pool, mem_dma_pool};
+static ILI9341_Mem_Stats_TypeDef mem_stats[ILI9341_MEM_REGIONS] =
+{
+	{ILI9341_MEM_CPU_SIZE, 0, 0, 0, 0},
+	{ILI9341_MEM_DMA_SIZE, 0, 0, 0, 0},
+};
+
+/**
+ * @brief  Allocates from a pool.
+ * @param  Region: ILI9341_MEM_CPU or ILI9341_MEM_DMA.
+ * @param  Size: Bytes wanted.
+ * @retval 4-byte aligned block, NULL when the pool is too full or empty, or
+ *         Region is not a pool.
+ */
+void* ILI9341_Mem_Alloc(uint8_t Region, uint32_t Size)
+{
+	if(Region >= ILI9341_MEM_REGIONS) return NULL;
+
+	ILI9341_Mem_Stats_TypeDef* stats = &mem_stats[Region];
+	uint32_t offset = stats->Used;
+	uint32_t free = stats->Size - offset;
+
+	//Size is checked before rounding up so the rounding cannot wrap around
+	if((stats->Size == 0) || (Size > free) || (((Size + 3) & ~3UL) > free))
+	{
+		stats->Failures++;
+		return NULL;
+	}
+	stats->Used = offset + ((Size + 3) & ~3UL);
+	if(stats->Used > stats->Peak)
+	{
+		stats->Peak = stats->Used;
+	}
+	return &mem_pool[Region][offset];
+}
+
+/**
+ * @brief  Returns the current top of a pool, for ILI9341_Mem_Release.
+ * @param  Region: ILI9341_MEM_CPU or ILI9341_MEM_DMA.
+ * @retval Mark of this region, 0 when Region is not a pool.
+ */
+uint32_t ILI9341_Mem_Mark(uint8_t Region)
+{
+	if(Region >= ILI9341_MEM_REGIONS) return 0;
+	return ILI9341_MEM_MARK_TAG(Region) | mem_stats[Region].Used;
+}
+
+/**
+ * @brief  Frees everything allocated from a pool since Mark was taken.
+ * @param  Region: ILI9341_MEM_CPU or ILI9341_MEM_DMA.
+ * @param  Mark: Value returned by ILI9341_Mem_Mark for the same region, 0 empties the pool.
+ * @retval 1 when released, 0 when the mark is refused (other region, or above
+ *         the top of the pool) and nothing changed.
+ *
+ * A DMA block must not be released while its transfer is still running
+ * (ILI9341_Wait_Idle first).
+ */
+uint8_t ILI9341_Mem_Release(uint8_t Region, uint32_t Mark)
+{
+	if(Region >= ILI9341_MEM_REGIONS) return 0;
+
+	ILI9341_Mem_Stats_TypeDef* stats = &mem_stats[Region];
+	uint32_t offset = Mark & ILI9341_MEM_MARK_OFFSET;
+
+	if((Mark != 0) && (((Mark & ~ILI9341_MEM_MARK_OFFSET) != ILI9341_MEM_MARK_TAG(Region)) || (offset > stats->Used)))
+	{
+		stats->Bad_Releases++;
+		return 0;
+	}
+	stats->Used = offset;
+	return 1;
+}
+
+/**
+ * @brief  Copies the usage counters of a pool.
+ * @param  Region: ILI9341_MEM_CPU or ILI9341_MEM_DMA.
+ * @param  Stats: Destination.
+ * @retval None
+ */
+void ILI9341_Mem_Get_Stats(uint8_t Region, ILI9341_Mem_Stats_TypeDef* Stats)
+{
+	if(Region >= ILI9341_MEM_REGIONS) return;
+	*Stats = mem_stats[Region];
+}
@@ -0,0 +1,79 @@
+/*
+ * ILI9341_Memory.h
+ *
+ *  Created on: Nov 27, 2024
+ *      Author: ellis
+ */
+
+#ifndef SRC_ILI9341_MEMORY_H_
+#define SRC_ILI9341_MEMORY_H_
+
+#include "ILI9341.h"
+
+#ifndef ILI9341_USE_CCMRAM
+#define ILI9341_USE_CCMRAM			1		//place CPU-only working sets in the 64 KB CCM RAM instead of SRAM
+#endif
+#ifndef ILI9341_RAM_CODE
+#define ILI9341_RAM_CODE			0		//run the hot drawing and transport loops from SRAM instead of flash
+#endif
+#ifndef ILI9341_MEM_CPU_SIZE
+#define ILI9341_MEM_CPU_SIZE		0		//bytes of the CPU-only pool (CCM RAM), 0 = no pool; the driver itself does not use it
+#endif
+#ifndef ILI9341_MEM_DMA_SIZE
+#define ILI9341_MEM_DMA_SIZE		0		//bytes of the DMA-reachable pool (SRAM), 0 = no pool
+#endif
+
+/*
+ * Placement of static buffers. CCM RAM sits on the core's D-bus only: no wait
+ * states and no contention with the DMA streaming pixels out of SRAM, but the
+ * DMA controllers cannot read it. Anything handed to ILI9341_Transmit_DMA or
+ * a DMA stream must be ILI9341_DMA_RAM.
+ */
+#if ILI9341_USE_CCMRAM
+#define ILI9341_CCMRAM				__attribute__((section(".ccmbss")))	//zeroed at start-up, see .ccmbss in the linker script
+#else
+#define ILI9341_CCMRAM
+#endif
+#define ILI9341_DMA_RAM				__attribute__((aligned(4)))			//plain .bss, i.e. SRAM
+
+/*
+ * Placement of hot code. With FLASH_LATENCY_5 every fetch that misses the ART
+ * cache stalls the core for 5 cycles; ILI9341_RAMFUNC functions are linked
+ * into .RamFunc, which the flash linker script puts in .data so the start-up
+ * code copies them to SRAM. CCM RAM cannot hold code (no I-bus). SRAM fetches
+ * share the bus matrix with the DMA reading the transfer buffers, so which
+ * placement wins depends on the workload: compare ILI9341_Bench_Run_All with
+ * ILI9341_RAM_CODE 0 and 1.
+ */
+#if ILI9341_RAM_CODE
+#define ILI9341_RAMFUNC				__attribute__((section(".RamFunc"), noinline))	//kept out of line, an inlined copy would run from its caller's section
+#else
+#define ILI9341_RAMFUNC
+#endif
+
+/*Whether the DMA can read Address (anything but CCM RAM)*/
+#ifdef CCMDATARAM_BASE
+#define ILI9341_DMA_REACHABLE(Address)	(((uintptr_t)(Address) < CCMDATARAM_BASE) || ((uintptr_t)(Address) > CCMDATARAM_END))
+#else
+#define ILI9341_DMA_REACHABLE(Address)	1
+#endif
+
+#define ILI9341_MEM_CPU				0		//pool in CCM RAM, CPU access only
+#define ILI9341_MEM_DMA				1		//pool in SRAM, may be sent by DMA
+#define ILI9341_MEM_REGIONS			2
+
+typedef struct
+{
+	uint32_t Size;				//bytes in the pool
+	uint32_t Used;				//bytes allocated now
+	uint32_t Peak;				//most bytes allocated at once since start-up
+	uint32_t Failures;			//allocations refused for lack of space
+	uint32_t Bad_Releases;		//releases refused: mark of another region, or above the top
+} ILI9341_Mem_Stats_TypeDef;
+
+void* ILI9341_Mem_Alloc(uint8_t Region, uint32_t Size);
+uint32_t ILI9341_Mem_Mark(uint8_t Region);
+uint8_t ILI9341_Mem_Release(uint8_t Region, uint32_t Mark);
+void ILI9341_Mem_Get_Stats(uint8_t Region, ILI9341_Mem_Stats_TypeDef* Stats);
+
+#endif /* SRC_ILI9341_MEMORY_H_ */
@@ -0,0 +1,160 @@
+/*
+ * ILI9341_Profile.c
+ *
+ *  Created on: Nov 27, 2024
+ *      Author: ellis
+ *
+ *  Per-function cycle accounting for the driver, compiled in with
+ *  ILI9341_PROFILE. Each instrumented function records its call count,
+ *  total and longest time in DWT cycles and the bytes it put on the bus.
+ *
+ *  Times and bytes are exclusive: an instrumented function called from
+ *  another one (Draw_Colour_Burst from Fill_Screen, Send_Buffer from
+ *  Draw_Text) is charged only to itself, so the rows add up to the time spent
+ *  in the driver. Uninstrumented helpers (Set_Address, Wait_Idle) and SPI
+ *  interrupts are charged to their caller. A call returns once its DMA
+ *  transfer is started, so bus time still running shows up in the next call
+ *  that waits for the bus.
+ */
+
+#include "ILI9341_Profile.h"
+#include "ILI9341_Memory.h"
+
+#if ILI9341_PROFILE
+
+#include <stdio.h>
+
+#define ILI9341_PROFILE_NAME(Name)	"ILI9341_" #Name,
+static const char* const profile_names[ILI9341_PROFILE_ID_COUNT] =
+{
+	ILI9341_PROFILE_FUNCTIONS(ILI9341_PROFILE_NAME)
+};
+
+#define ILI9341_PROFILE_DEPTH		8		//deepest nesting of instrumented calls tracked
+
+static ILI9341_Profile_Entry_TypeDef profile[ILI9341_PROFILE_ID_COUNT] ILI9341_CCMRAM;
+static uint32_t profile_start_tick;
+static uint8_t	profile_depth;								//instrumented calls in progress
+static uint32_t	profile_callee_cycles[ILI9341_PROFILE_DEPTH];	//spent in instrumented callees, per level
+static uint32_t	profile_callee_bytes[ILI9341_PROFILE_DEPTH];
+
+/**
+ * @brief  Records the entry of an instrumented function.
+ * @param  Id: ILI9341_PROFILE_ID_xxx.
+ * @retval Frame handed back to ILI9341_Profile_Exit.
+ */
+ILI9341_Profile_Frame_TypeDef ILI9341_Profile_Enter(uint8_t Id)
+{
+	ILI9341_Profile_Frame_TypeDef frame;
+	ILI9341_Traffic_TypeDef traffic;
+
+	ILI9341_Get_Traffic(&traffic);
+	frame.Id = Id;
+	frame.Depth = profile_depth;
+	if(profile_depth < ILI9341_PROFILE_DEPTH)
+	{
+		profile_callee_cycles[profile_depth] = 0;
+		profile_callee_bytes[profile_depth] = 0;
+	}
+	profile_depth++;
+	frame.Bytes = traffic.Bytes;
+	frame.Start = DWT->CYCCNT;
+	return frame;
+}
+
+/**
+ * @brief  Records the exit of an instrumented function (cleanup handler of ILI9341_PROFILE_FUNCTION).
+ * @param  Frame: Frame returned by ILI9341_Profile_Enter.
+ * @retval None
+ */
+void ILI9341_Profile_Exit(ILI9341_Profile_Frame_TypeDef* Frame)
+{
+	uint32_t cycles = DWT->CYCCNT - Frame->Start;
+	ILI9341_Profile_Entry_TypeDef* entry = &profile[Frame->Id];
+	ILI9341_Traffic_TypeDef traffic;
+
+	uint32_t bytes;
+
+	ILI9341_Get_Traffic(&traffic);
+	bytes = traffic.Bytes - Frame->Bytes;
+	profile_depth = Frame->Depth;
+	if(Frame->Depth > 0 && Frame->Depth <= ILI9341_PROFILE_DEPTH)
+	{
+		//the caller does not count this call again
+		profile_callee_cycles[Frame->Depth - 1] += cycles;
+		profile_callee_bytes[Frame->Depth - 1] += bytes;
+	}
+	if(Frame->Depth < ILI9341_PROFILE_DEPTH)
+	{
+		cycles -= profile_callee_cycles[Frame->Depth];
+		bytes -= profile_callee_bytes[Frame->Depth];
+	}
+	entry->Calls++;
+	entry->Cycles += cycles;
+	if(cycles > entry->Max_Cycles)
+	{
+		entry->Max_Cycles = cycles;
+	}
+	entry->Bytes += bytes;
+}
+
+/**
+ * @brief  Clears all counters and starts the DWT cycle counter.
+ * @retval None
+ */
+void ILI9341_Profile_Reset(void)
+{
+	ILI9341_Cycles();	//starts the counter on first use
+	profile_depth = 0;
+	for(uint32_t i = 0; i < ILI9341_PROFILE_ID_COUNT; i++)
+	{
+		profile[i].Calls = 0;
+		profile[i].Max_Cycles = 0;
+		profile[i].Cycles = 0;
+		profile[i].Bytes = 0;
+	}
+	profile_start_tick = HAL_GetTick();
+}
+
+/**
+ * @brief  Copies the counters of one function.
+ * @param  Id: ILI9341_PROFILE_ID_xxx.
+ * @param  Entry: Destination.
+ * @retval None
+ */
+void ILI9341_Profile_Get(uint8_t Id, ILI9341_Profile_Entry_TypeDef* Entry)
+{
+	*Entry = profile[Id];
+}
+
+/**
+ * @brief  Prints the counters of every function called since the last reset, as CSV.
+ * @retval None
+ *
+ * Goes through printf, i.e. USART1 (__io_putchar in Utility.c) on target.
+ * share is the total time of the function over the time since
+ * ILI9341_Profile_Reset; the rest is time spent outside the driver.
+ */
+void ILI9341_Profile_Dump(void)
+{
+	uint32_t cycles_per_us = SystemCoreClock / 1000000;
+	uint32_t elapsed_us = (HAL_GetTick() - profile_start_tick) * 1000;
+
+	printf("# ILI9341 profile, %lu ms since reset\n", (unsigned long)(elapsed_us / 1000));
+	printf("function,calls,total_us,avg_cycles,max_cycles,bytes,share\n");
+	for(uint32_t i = 0; i < ILI9341_PROFILE_ID_COUNT; i++)
+	{
+		const ILI9341_Profile_Entry_TypeDef* entry = &profile[i];
+		uint32_t total_us, share;
+
+		if(entry->Calls == 0) continue;
+		total_us = entry->Cycles / cycles_per_us;
+		share = elapsed_us ? (uint64_t)total_us * 1000 / elapsed_us : 0;
+		printf("%s,%lu,%lu,%lu,%lu,%lu,%lu.%lu%%\n", profile_names[i], (unsigned long)entry->Calls,
+			   (unsigned long)total_us, (unsigned long)(entry->Cycles / entry->Calls),
+			   (unsigned long)entry->Max_Cycles, (unsigned long)entry->Bytes,
+			   (unsigned long)(share / 10), (unsigned long)(share % 10));
+	}
+}
+
+#endif /* ILI9341_PROFILE */
@@ -0,0 +1,112 @@
+/*
+ * ILI9341_Profile.h
+ *
+ *  Created on: Nov 27, 2024
+ *      Author: ellis
+ */
+
+#ifndef SRC_ILI9341_PROFILE_H_
+#define SRC_ILI9341_PROFILE_H_
+
+#include "ILI9341.h"
+
+/*
+ * Instrumented entry points, X(Name) stands for ILI9341_<Name>. The public
+ * drawing, band, indexed and transfer API only: the per-call bus helpers
+ * (Set_Address, Write_Command, Bus_Mode, Wait_Idle...) run for every pixel
+ * call and the timing would cost more than they do.
+ */
+#define ILI9341_PROFILE_FUNCTIONS(X)	\
+	X(Transmit_DMA)					\
+	X(Transmit_DMA_Rows)			\
+	X(Acquire_Buffer)				\
+	X(Send_Buffer)					\
+	X(Release_Buffer)				\
+	X(Read_Register)				\
+	X(Reset)						\
+	X(Set_Rotation)					\
+	X(Run_Init_Table)				\
+	X(Init_Poll)					\
+	X(Init)							\
+	X(Draw_Colour_Burst)			\
+	X(Fill_Screen)					\
+	X(Draw_Pixel)					\
+	X(Draw_Pixels)					\
+	X(Draw_Rectangle)				\
+	X(Draw_Horizontal_Line)			\
+	X(Draw_Vertical_Line)			\
+	X(Draw_Hollow_Circle)			\
+	X(Draw_Filled_Circle)			\
+	X(Draw_Hollow_Rectangle_Coord)	\
+	X(Draw_Filled_Rectangle_Coord)	\
+	X(Draw_Char)					\
+	X(Draw_Text)					\
+	X(Draw_Bitmap)					\
+	X(Draw_Image)					\
+	X(Image_Draw)					\
+	X(Image_Invalidate_Palette)		\
+	X(Band_Begin)					\
+	X(Band_Invalidate)				\
+	X(Band_Invalidate_All)			\
+	X(Band_Fill_Rect)				\
+	X(Band_Pixel)					\
+	X(Band_Hollow_Circle)			\
+	X(Band_Filled_Circle)			\
+	X(Band_Text)					\
+	X(Band_Bitmap)					\
+	X(Band_End)						\
+	X(Set_Render_Mode)				\
+	X(Indexed_Set_Palette)			\
+	X(Indexed_Reset_Palette)		\
+	X(Indexed_Invalidate)			\
+	X(Indexed_Fill_Rect)			\
+	X(Indexed_Draw_Pixels)			\
+	X(Indexed_Draw_Glyphs)			\
+	X(Indexed_Draw_Bitmap)			\
+	X(Indexed_Flush)
+
+#if ILI9341_PROFILE
+
+#define ILI9341_PROFILE_ENUM(Name)	ILI9341_PROFILE_ID_##Name,
+enum
+{
+	ILI9341_PROFILE_FUNCTIONS(ILI9341_PROFILE_ENUM)
+	ILI9341_PROFILE_ID_COUNT
+};
+
+typedef struct
+{
+	uint32_t	Calls;
+	uint32_t	Max_Cycles;		//longest single call
+	uint64_t	Cycles;			//all calls, instrumented callees excluded
+	uint32_t	Bytes;			//bytes sent to the display by the function itself
+} ILI9341_Profile_Entry_TypeDef;
+
+typedef struct
+{
+	uint8_t		Id;
+	uint8_t		Depth;			//nesting level, indexes the callee totals
+	uint32_t	Start;
+	uint32_t	Bytes;
+} ILI9341_Profile_Frame_TypeDef;
+
+ILI9341_Profile_Frame_TypeDef ILI9341_Profile_Enter(uint8_t Id);
+void ILI9341_Profile_Exit(ILI9341_Profile_Frame_TypeDef* Frame);
+void ILI9341_Profile_Reset(void);
+void ILI9341_Profile_Get(uint8_t Id, ILI9341_Profile_Entry_TypeDef* Entry);
+void ILI9341_Profile_Dump(void);
+
+/*First statement of an instrumented function; the exit is recorded on every return path*/
+#define ILI9341_PROFILE_FUNCTION(Name)	\
+	ILI9341_Profile_Frame_TypeDef profile_frame __attribute__((cleanup(ILI9341_Profile_Exit))) = \
+		ILI9341_Profile_Enter(ILI9341_PROFILE_ID_##Name)
+
+#else
+
+#define ILI9341_PROFILE_FUNCTION(Name)
+#define ILI9341_Profile_Reset()
+#define ILI9341_Profile_Dump()
+
+#endif /* ILI9341_PROFILE */
+
+#endif /* SRC_ILI9341_PROFILE_H_ */
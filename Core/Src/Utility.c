@@ -57,31 +57,74 @@ void Configure_Clock(void)
 }*/
 //*********************************************************************
 //Setup do timer 2
+//O TIM2 tem 32 bits e conta livremente em us, sem nunca ser zerado pelos
+//atrasos, então serve de relógio para medir tempo. Dá a volta a cada
+//2^32 us (~71,6 min); compare tempos sempre pela diferença.
 //*********************************************************************
 void TIM2_Setup(void)
 {
-    // Ativar o clock do Timer3
-    RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;  // Corrigido para TIM3
+    // Ativar o clock do Timer2
+    RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;
     TIM2->PSC = 83;                      // Prescaler para incrementos a cada 1us (assumindo que o clock é 84MHz)
+    TIM2->ARR = 0xFFFFFFFF;              // Contagem livre em 32 bits
     TIM2->EGR = TIM_EGR_UG;              // Evento de atualização para escrever o valor do prescaler
     TIM2->CR1 |= TIM_CR1_CEN;            // Habilita o timer
 }
 //*********************************************************************
+//Retorna o tempo atual em us (contador livre do TIM2)
+//*********************************************************************
+uint32_t Micros(void)
+{
+	return TIM2->CNT;
+}
+//*********************************************************************
+//Retorna o prazo que vence daqui a delay us, para Deadline_Expired
+//*********************************************************************
+uint32_t Deadline_us(uint32_t delay)
+{
+	return Micros() + delay;
+}
+//*********************************************************************
+//Retorna 1 se o prazo já venceu, sem bloquear
+//A diferença com sinal continua correta quando o contador dá a volta,
+//desde que o prazo esteja a menos de 2^31 us (~35 min)
+//*********************************************************************
+uint8_t Deadline_Expired(uint32_t deadline)
+{
+	return (int32_t)(Micros() - deadline) >= 0;
+}
+//*********************************************************************
+//Espera o prazo vencer e agenda o próximo period us depois dele
+//Usado para manter um ritmo fixo (ex.: quadros por segundo) sem acumular
+//atraso: o próximo prazo conta a partir do anterior, não de agora
+//*********************************************************************
+void Delay_Until(uint32_t* deadline, uint32_t period)
+{
+	while(!Deadline_Expired(*deadline));	//aguarda o prazo
+	*deadline += period;					//agenda o próximo
+}
+//*********************************************************************
 //Criação de atraso em us
 //*********************************************************************
 void Delay_us(uint32_t delay)
 {
-	TIM2->CNT = 0;				//inicializa o contador com 0
-	while(TIM2->CNT < delay);	//aguarda o tempo passar
+	uint32_t start = Micros();				//instante inicial, o contador não é zerado
+	while((Micros() - start) < delay);		//aguarda o tempo passar
 }
 //*********************************************************************
 //Criação de atraso em ms
 //*********************************************************************
 void Delay_ms(uint32_t delay)
 {
-	uint32_t max = 1000*delay;
-	TIM2->CNT = 0;				//inicializa o contador com 0
-	while(TIM2->CNT < max);		//aguarda o tempo passar
+	uint32_t start = Micros();
+	while(delay > 0)						//conta 1 ms por vez, sem estourar 32 bits em atrasos longos
+	{
+		if((Micros() - start) >= 1000)
+		{
+			start += 1000;
+			delay--;
+		}
+	}
 }
 
 //*********************************************************************
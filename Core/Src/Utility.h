@@ -54,7 +54,11 @@ void Utility_Init(void);		//inicialização de funções da biblioteca
 void Configure_Clock(void);		//configuração do sistema de clock
 
 //Funções de timers e temporização
-void TIM2_Setup(void);				//configuração do Timer2 como base de tempo de 1us
+void TIM2_Setup(void);				//configuração do Timer2 como relógio livre de 1us
+uint32_t Micros(void);				//tempo atual em us, monotônico (dá a volta em 2^32 us)
+uint32_t Deadline_us(uint32_t delay);		//prazo que vence daqui a delay us
+uint8_t Deadline_Expired(uint32_t deadline);	//retorna 1 se o prazo venceu (não bloqueia)
+void Delay_Until(uint32_t* deadline, uint32_t period);	//espera o prazo e agenda o próximo (ritmo de quadros)
 void Delay_us(uint32_t delay);		//atraso em us
 void Delay_ms(uint32_t delay);		//atraso em ms
 
@@ -25,6 +25,8 @@
 #include "Utility.h"
 #include "ILI9341.h"
 #include "ILI9341_GFX.h"
+#include "ILI9341_Bench.h"
+#include "ILI9341_Profile.h"
 #include "string.h"
 #include "stdio.h"
 #include "snow_tiger.h"
@@ -43,6 +45,8 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
+#define RUN_BENCHMARK	0		//1: print the ILI9341_Bench report on USART1 once after init
+#define COUNTING_FRAME_US	0		//pace the counting screen on the TIM2 clock (Micros), e.g. 100000 for 10 frames/s; 0 draws flat out
 
 /* USER CODE END PD */
 
@@ -55,6 +59,7 @@
 RNG_HandleTypeDef hrng;
 
 SPI_HandleTypeDef hspi2;
+DMA_HandleTypeDef hdma_spi2_tx;
 
 /* USER CODE BEGIN PV */
 uint8_t outbuff[512];
@@ -64,6 +69,7 @@ uint8_t inbuff[512];
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_SPI2_Init(void);
 static void MX_RNG_Init(void);
 /* USER CODE BEGIN PFP */
@@ -105,10 +111,19 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_SPI2_Init();
   MX_RNG_Init();
   /* USER CODE BEGIN 2 */
-  ILI9341_Init();
+  ILI9341_Init_Start();
+  /* Start-up work that does not need the display can run here while the panel powers up */
+  while(ILI9341_Init_Poll() != ILI9341_INIT_READY)
+  {
+  }
+#if RUN_BENCHMARK
+  ILI9341_Bench_Run_All(snow_tiger);
+#endif
+  ILI9341_Profile_Reset();
   /* USER CODE END 2 */
 
   /* Infinite loop */
@@ -131,8 +146,15 @@ int main(void)
 		ILI9341_Fill_Screen(WHITE);
 
 		char Temp_Buffer_text[40];
+		uint32_t frame_deadline = Micros();
+		uint32_t counting_us = 0;	//drawing only, the pacing waits are left out
 		for(uint16_t i = 0; i <= 10; i++)
 		{
+			if(COUNTING_FRAME_US != 0)
+			{
+				Delay_Until(&frame_deadline, COUNTING_FRAME_US);	//one frame per period, whatever the drawing took
+			}
+			uint32_t frame_start = Micros();
 			sprintf(Temp_Buffer_text, "Counting: %d", i);
 			ILI9341_Draw_Text(Temp_Buffer_text, 10, 10, BLACK, 2, WHITE);
 			ILI9341_Draw_Text(Temp_Buffer_text, 10, 30, BLUE, 2, WHITE);
@@ -145,7 +167,10 @@ int main(void)
 			ILI9341_Draw_Text(Temp_Buffer_text, 10, 170, WHITE, 2, BLACK);
 			ILI9341_Draw_Text(Temp_Buffer_text, 10, 190, BLUE, 2, BLACK);
 			ILI9341_Draw_Text(Temp_Buffer_text, 10, 210, RED, 2, BLACK);
+			ILI9341_Wait_Idle();
+			counting_us += Micros() - frame_start;
 		}
+		printf("Counting, 11 frames: %lu us drawing\n", (unsigned long)counting_us);
 
 		HAL_Delay(3000);
 		ILI9341_Fill_Screen(WHITE);
@@ -156,6 +181,7 @@ int main(void)
 		ILI9341_Fill_Screen(WHITE);
 
 
+		uint32_t circles_start = Micros();
 		for(uint32_t i = 0; i < 3000; i++)
 		{
 			uint32_t random_num = 0;
@@ -178,6 +204,8 @@ int main(void)
 			//ili9341_drawpixel(xr, yr, WHITE);
 			ILI9341_Draw_Hollow_Circle(xr, yr, radiusr*2, colourr);
 		}
+		ILI9341_Wait_Idle();
+		printf("3000 circles: %lu us\n", (unsigned long)(Micros() - circles_start));
 		HAL_Delay(1000);
 		ILI9341_Fill_Screen(WHITE);
 		ILI9341_Set_Rotation(SCREEN_HORIZONTAL_2);
@@ -187,7 +215,8 @@ int main(void)
 		//ILI9341_Draw_Image((const char*)snow_tiger, SCREEN_VERTICAL_2);
 		ILI9341_Set_Rotation(SCREEN_VERTICAL_1);
 		HAL_Delay(10000);
-
+		ILI9341_Profile_Dump();		//per-function driver times of this loop when ILI9341_PROFILE is 1
+		ILI9341_Profile_Reset();
   }
   /* USER CODE END 3 */
 }
@@ -302,6 +331,22 @@ static void MX_SPI2_Init(void)
 
 }
 
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA1_Stream4_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream4_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream4_IRQn);
+
+}
+
 /**
   * @brief GPIO Initialization Function
   * @param None
@@ -6,7 +6,13 @@
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
 ../Core/Src/ILI9341.c \
+../Core/Src/ILI9341_Band.c \
+../Core/Src/ILI9341_Bench.c \
 ../Core/Src/ILI9341_GFX.c \
+../Core/Src/ILI9341_Image.c \
+../Core/Src/ILI9341_Indexed.c \
+../Core/Src/ILI9341_Memory.c \
+../Core/Src/ILI9341_Profile.c \
 ../Core/Src/Utility.c \
 ../Core/Src/main.c \
 ../Core/Src/stm32f4xx_hal_msp.c \
@@ -17,7 +23,13 @@ C_SRCS += \
 
 OBJS += \
 ./Core/Src/ILI9341.o \
+./Core/Src/ILI9341_Band.o \
+./Core/Src/ILI9341_Bench.o \
 ./Core/Src/ILI9341_GFX.o \
+./Core/Src/ILI9341_Image.o \
+./Core/Src/ILI9341_Indexed.o \
+./Core/Src/ILI9341_Memory.o \
+./Core/Src/ILI9341_Profile.o \
 ./Core/Src/Utility.o \
 ./Core/Src/main.o \
 ./Core/Src/stm32f4xx_hal_msp.o \
@@ -28,7 +40,13 @@ OBJS += \
 
 C_DEPS += \
 ./Core/Src/ILI9341.d \
+./Core/Src/ILI9341_Band.d \
+./Core/Src/ILI9341_Bench.d \
 ./Core/Src/ILI9341_GFX.d \
+./Core/Src/ILI9341_Image.d \
+./Core/Src/ILI9341_Indexed.d \
+./Core/Src/ILI9341_Memory.d \
+./Core/Src/ILI9341_Profile.d \
 ./Core/Src/Utility.d \
 ./Core/Src/main.d \
 ./Core/Src/stm32f4xx_hal_msp.d \
@@ -45,7 +63,7 @@ Core/Src/%.o Core/Src/%.su Core/Src/%.cyclo: ../Core/Src/%.c Core/Src/subdir.mk
 clean: clean-Core-2f-Src
 
 clean-Core-2f-Src:
-	-$(RM) ./Core/Src/ILI9341.cyclo ./Core/Src/ILI9341.d ./Core/Src/ILI9341.o ./Core/Src/ILI9341.su ./Core/Src/ILI9341_GFX.cyclo ./Core/Src/ILI9341_GFX.d ./Core/Src/ILI9341_GFX.o ./Core/Src/ILI9341_GFX.su ./Core/Src/Utility.cyclo ./Core/Src/Utility.d ./Core/Src/Utility.o ./Core/Src/Utility.su ./Core/Src/main.cyclo ./Core/Src/main.d ./Core/Src/main.o ./Core/Src/main.su ./Core/Src/stm32f4xx_hal_msp.cyclo ./Core/Src/stm32f4xx_hal_msp.d ./Core/Src/stm32f4xx_hal_msp.o ./Core/Src/stm32f4xx_hal_msp.su ./Core/Src/stm32f4xx_it.cyclo ./Core/Src/stm32f4xx_it.d ./Core/Src/stm32f4xx_it.o ./Core/Src/stm32f4xx_it.su ./Core/Src/syscalls.cyclo ./Core/Src/syscalls.d ./Core/Src/syscalls.o ./Core/Src/syscalls.su ./Core/Src/sysmem.cyclo ./Core/Src/sysmem.d ./Core/Src/sysmem.o ./Core/Src/sysmem.su ./Core/Src/system_stm32f4xx.cyclo ./Core/Src/system_stm32f4xx.d ./Core/Src/system_stm32f4xx.o ./Core/Src/system_stm32f4xx.su
+	-$(RM) ./Core/Src/ILI9341.cyclo ./Core/Src/ILI9341.d ./Core/Src/ILI9341.o ./Core/Src/ILI9341.su ./Core/Src/ILI9341_Band.cyclo ./Core/Src/ILI9341_Band.d ./Core/Src/ILI9341_Band.o ./Core/Src/ILI9341_Band.su ./Core/Src/ILI9341_Bench.cyclo ./Core/Src/ILI9341_Bench.d ./Core/Src/ILI9341_Bench.o ./Core/Src/ILI9341_Bench.su ./Core/Src/ILI9341_GFX.cyclo ./Core/Src/ILI9341_GFX.d ./Core/Src/ILI9341_GFX.o ./Core/Src/ILI9341_GFX.su ./Core/Src/ILI9341_Image.cyclo ./Core/Src/ILI9341_Image.d ./Core/Src/ILI9341_Image.o ./Core/Src/ILI9341_Image.su ./Core/Src/ILI9341_Indexed.cyclo ./Core/Src/ILI9341_Indexed.d ./Core/Src/ILI9341_Indexed.o ./Core/Src/ILI9341_Indexed.su ./Core/Src/ILI9341_Memory.cyclo ./Core/Src/ILI9341_Memory.d ./Core/Src/ILI9341_Memory.o ./Core/Src/ILI9341_Memory.su ./Core/Src/ILI9341_Profile.cyclo ./Core/Src/ILI9341_Profile.d ./Core/Src/ILI9341_Profile.o ./Core/Src/ILI9341_Profile.su ./Core/Src/Utility.cyclo ./Core/Src/Utility.d ./Core/Src/Utility.o ./Core/Src/Utility.su ./Core/Src/main.cyclo ./Core/Src/main.d ./Core/Src/main.o ./Core/Src/main.su ./Core/Src/stm32f4xx_hal_msp.cyclo ./Core/Src/stm32f4xx_hal_msp.d ./Core/Src/stm32f4xx_hal_msp.o ./Core/Src/stm32f4xx_hal_msp.su ./Core/Src/stm32f4xx_it.cyclo ./Core/Src/stm32f4xx_it.d ./Core/Src/stm32f4xx_it.o ./Core/Src/stm32f4xx_it.su ./Core/Src/syscalls.cyclo ./Core/Src/syscalls.d ./Core/Src/syscalls.o ./Core/Src/syscalls.su ./Core/Src/sysmem.cyclo ./Core/Src/sysmem.d ./Core/Src/sysmem.o ./Core/Src/sysmem.su ./Core/Src/system_stm32f4xx.cyclo ./Core/Src/system_stm32f4xx.d ./Core/Src/system_stm32f4xx.o ./Core/Src/system_stm32f4xx.su
 
 .PHONY: clean-Core-2f-Src
 
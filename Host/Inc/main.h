@@ -0,0 +1,24 @@
+/*
+ * main.h
+ *
+ *  Host build stand-in for Core/Inc/main.h: the display pin names used by the
+ *  driver, mapped onto the simulated GPIO port.
+ */
+
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#include "stm32f4xx_hal.h"
+
+void Error_Handler(void);
+
+#define CHIP_SELECT_Pin GPIO_PIN_9
+#define CHIP_SELECT_GPIO_Port GPIOD
+#define RESET_Pin GPIO_PIN_10
+#define RESET_GPIO_Port GPIOD
+#define DC_Pin GPIO_PIN_11
+#define DC_GPIO_Port GPIOD
+#define CHIP_SELECT_SDCARD_Pin GPIO_PIN_12
+#define CHIP_SELECT_SDCARD_GPIO_Port GPIOD
+
+#endif /* __MAIN_H */
@@ -0,0 +1,66 @@
+/*
+ * sim_panel.h
+ *
+ *  Simulated ILI9341 panel for the host build. The HAL stubs feed every byte
+ *  clocked out on SPI2 into a command decoder that keeps a 240x320 GRAM.
+ */
+
+#ifndef SIM_PANEL_H_
+#define SIM_PANEL_H_
+
+#include <stdint.h>
+
+#define SIM_GRAM_WIDTH		240
+#define SIM_GRAM_HEIGHT		320
+
+typedef struct
+{
+	uint64_t Bytes;				//bytes clocked while CS was low
+	uint64_t Command_Bytes;		//of which with DC low
+	uint64_t Pixel_Bytes;		//memory write (0x2C) data bytes
+	uint64_t Pixels;			//pixels written into GRAM inside the panel area
+	uint64_t CS_Toggles;		//CS edges
+	uint64_t Transfers;			//blocking HAL_SPI_Transmit calls
+	uint64_t DMA_Transfers;		//HAL_SPI_Transmit_DMA calls
+	uint64_t Reconfigurations;	//HAL_SPI_Init calls (bus mode and read speed changes)
+	uint64_t Errors;			//bytes sent with CS high
+} Sim_Stats_TypeDef;
+
+/*Cost model, all overheads in nanoseconds*/
+typedef struct
+{
+	uint32_t APB1_Hz;			//SPI2 kernel clock, the bit rate is APB1_Hz / BaudRatePrescaler
+	uint32_t Frame_Gap_ns;		//idle time between frames of a blocking HAL_SPI_Transmit
+	uint32_t GPIO_Write_ns;		//HAL_GPIO_WritePin (CS, DC, RESET)
+	uint32_t Transmit_Call_ns;	//HAL_SPI_Transmit/Receive entry, flag polling and exit
+	uint32_t DMA_Start_ns;		//HAL_SPI_Transmit_DMA and HAL_DMA_Start_IT
+	uint32_t DMA_Complete_ns;	//DMA interrupt, end-of-transfer flag wait and TxCplt callback
+	uint32_t SPI_Init_ns;		//HAL_SPI_Init
+	uint32_t DMA_Init_ns;		//HAL_DMA_Init
+	uint32_t Tick_Poll_ns;		//HAL_GetTick, so busy-wait loops advance time
+} Sim_Timing_TypeDef;
+
+/*Cost of a group of driver calls, see Sim_Measure_Start*/
+typedef struct
+{
+	double		Time_us;			//estimated time on target
+	uint64_t	Bytes;				//bytes on the wire
+	uint64_t	Command_Bytes;		//command bytes (DC low)
+	uint64_t	Pixel_Bytes;		//pixel data bytes
+	uint64_t	CS_Toggles;
+	double		Efficiency;			//Pixel_Bytes / Bytes
+	double		Bus_Utilisation;	//time the SPI clock runs / Time_us
+} Sim_Cost_TypeDef;
+
+void Sim_Init(void);
+void Sim_Get_Stats(Sim_Stats_TypeDef* Stats);
+void Sim_Reset_Stats(void);
+uint64_t Sim_Time_ns(void);
+void Sim_Get_Timing(Sim_Timing_TypeDef* Timing);
+void Sim_Set_Timing(const Sim_Timing_TypeDef* Timing);
+void Sim_Measure_Start(void);
+void Sim_Measure_Stop(Sim_Cost_TypeDef* Cost);
+uint16_t Sim_Get_Pixel(uint16_t X, uint16_t Y);
+int Sim_Save_PPM(const char* Path);
+
+#endif /* SIM_PANEL_H_ */
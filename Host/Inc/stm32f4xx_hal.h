@@ -0,0 +1,77 @@
+/*
+ * stm32f4xx_hal.h
+ *
+ *  Host build stand-in for the STM32F4 HAL. Only the types, constants and
+ *  calls used by the ILI9341 driver are declared; Src/sim_panel.c implements
+ *  them on top of a simulated panel.
+ */
+
+#ifndef SIM_STM32F4XX_HAL_H_
+#define SIM_STM32F4XX_HAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define __weak __attribute__((weak))
+
+typedef enum { HAL_OK = 0, HAL_ERROR, HAL_BUSY, HAL_TIMEOUT } HAL_StatusTypeDef;
+#define HAL_MAX_DELAY				0xFFFFFFFFU
+
+/*GPIO*/
+typedef enum { GPIO_PIN_RESET = 0, GPIO_PIN_SET } GPIO_PinState;
+typedef struct { uint32_t ODR; } GPIO_TypeDef;
+extern GPIO_TypeDef Sim_GPIOD;
+#define GPIOD						(&Sim_GPIOD)
+#define GPIO_PIN_9					((uint16_t)0x0200)
+#define GPIO_PIN_10					((uint16_t)0x0400)
+#define GPIO_PIN_11					((uint16_t)0x0800)
+#define GPIO_PIN_12					((uint16_t)0x1000)
+
+/*DMA*/
+#define DMA_MINC_ENABLE				0x00000400U
+#define DMA_MINC_DISABLE			0x00000000U
+#define DMA_PDATAALIGN_BYTE			0x00000000U
+#define DMA_PDATAALIGN_HALFWORD		0x00000800U
+#define DMA_MDATAALIGN_BYTE			0x00000000U
+#define DMA_MDATAALIGN_HALFWORD		0x00002000U
+typedef struct { uint32_t MemInc, PeriphDataAlignment, MemDataAlignment; } DMA_InitTypeDef;
+typedef struct __DMA_HandleTypeDef { DMA_InitTypeDef Init; } DMA_HandleTypeDef;
+
+/*SPI*/
+#define SPI_DATASIZE_8BIT			0x00000000U
+#define SPI_DATASIZE_16BIT			0x00000800U
+#define SPI_BAUDRATEPRESCALER_2		0x00000000U
+#define SPI_BAUDRATEPRESCALER_4		0x00000008U
+#define SPI_BAUDRATEPRESCALER_8		0x00000010U
+#define SPI_BAUDRATEPRESCALER_16	0x00000018U
+typedef struct { uint32_t DataSize; uint32_t BaudRatePrescaler; } SPI_InitTypeDef;
+typedef struct { uint32_t CR1; } SPI_TypeDef;
+typedef struct __SPI_HandleTypeDef
+{
+	SPI_TypeDef*		Instance;
+	SPI_InitTypeDef		Init;
+	DMA_HandleTypeDef*	hdmatx;
+} SPI_HandleTypeDef;
+
+/*Core debug cycle counter*/
+typedef struct { volatile uint32_t CTRL; volatile uint32_t CYCCNT; } DWT_Type;
+typedef struct { volatile uint32_t DEMCR; } CoreDebug_Type;
+extern DWT_Type Sim_DWT;
+extern CoreDebug_Type Sim_CoreDebug;
+#define DWT							(&Sim_DWT)
+#define CoreDebug					(&Sim_CoreDebug)
+#define DWT_CTRL_CYCCNTENA_Msk		1U
+#define CoreDebug_DEMCR_TRCENA_Msk	(1U << 24)
+extern uint32_t SystemCoreClock;
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+HAL_StatusTypeDef HAL_SPI_Init(SPI_HandleTypeDef *hspi);
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size);
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi);
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma);
+void HAL_Delay(uint32_t Delay);
+uint32_t HAL_GetTick(void);
+
+#endif /* SIM_STM32F4XX_HAL_H_ */
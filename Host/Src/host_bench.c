@@ -0,0 +1,31 @@
+/*
+ * host_bench.c
+ *
+ *  Runs the ILI9341_Bench cases against the simulated panel and prints the
+ *  same CSV report as the target. Times come from the bus cost model in
+ *  sim_panel.c (CPU time between HAL calls is not included).
+ *
+ *  Built with ILI9341_PROFILE=1 (make profile) it also prints the
+ *  per-function driver profile of the whole run. DMA transfers finish inside
+ *  the call in the simulator, so their bus time is charged to the function
+ *  that starts them rather than to the next call that waits for the bus as
+ *  on target.
+ *
+ *  Usage: host_bench > bench.csv
+ */
+
+#include "ILI9341.h"
+#include "ILI9341_Bench.h"
+#include "ILI9341_Profile.h"
+#include "sim_panel.h"
+#include "snow_tiger.h"
+
+int main(void)
+{
+	Sim_Init();
+	ILI9341_Init();
+	ILI9341_Profile_Reset();
+	ILI9341_Bench_Run_All(snow_tiger);
+	ILI9341_Profile_Dump();
+	return 0;
+}
@@ -0,0 +1,89 @@
+/*
+ * host_cost.c
+ *
+ *  Estimates what each driver call costs on target: time, bytes on the wire
+ *  and how many of them are pixel data, from the bus cost model in
+ *  sim_panel.c. The address window cache is invalidated before every call so
+ *  each figure includes its CASET/PASET/RAMWR, like a first call would.
+ *
+ *  Usage: host_cost            (cost model overrides via SIM_TIMING, see sim_panel.c)
+ */
+
+#include <stdio.h>
+#include "ILI9341.h"
+#include "ILI9341_GFX.h"
+#include "sim_panel.h"
+#include "snow_tiger.h"
+
+static ILI9341_Point_TypeDef points[256];
+
+/**
+ * @brief  Runs Call once after a cold window cache and prints its cost.
+ */
+#define COST(Name, Call)		\
+	do							\
+	{							\
+		Sim_Cost_TypeDef cost;	\
+		ILI9341_Wait_Idle();	\
+		ILI9341_Invalidate_Window();	\
+		Sim_Measure_Start();	\
+		Call;					\
+		ILI9341_Wait_Idle();	\
+		Sim_Measure_Stop(&cost);	\
+		Cost_Print(Name, &cost);	\
+	} while(0)
+
+static void Cost_Print(const char* Name, const Sim_Cost_TypeDef* Cost)
+{
+	printf("%-28s %10.1f %9llu %7llu %9llu %6.1f%% %6.1f%% %9.0f\n", Name, Cost->Time_us,
+		   (unsigned long long)Cost->Bytes, (unsigned long long)Cost->Command_Bytes,
+		   (unsigned long long)Cost->Pixel_Bytes, Cost->Efficiency * 100, Cost->Bus_Utilisation * 100,
+		   Cost->Time_us > 0 ? 1e6 / Cost->Time_us : 0.0);
+}
+
+int main(void)
+{
+	Sim_Timing_TypeDef timing;
+
+	Sim_Init();
+	Sim_Get_Timing(&timing);
+	printf("SPI2 %.1f Mbit/s, GPIO %u ns, HAL_SPI_Transmit %u ns, DMA start %u ns + complete %u ns\n\n",
+		   timing.APB1_Hz / 2e6, timing.GPIO_Write_ns, timing.Transmit_Call_ns,
+		   timing.DMA_Start_ns, timing.DMA_Complete_ns);
+	printf("%-28s %10s %9s %7s %9s %7s %7s %9s\n", "call", "us", "bytes", "command", "pixel", "payload", "bus", "calls/s");
+
+	COST("Init", ILI9341_Init());
+	ILI9341_Set_Rotation(SCREEN_HORIZONTAL_2);
+
+	COST("Fill_Screen", ILI9341_Fill_Screen(WHITE));
+	COST("Draw_Pixel", ILI9341_Draw_Pixel(10, 10, BLACK));
+	for(uint32_t i = 0; i < 256; i++)
+	{
+		points[i].X = (i * 37) % 320;
+		points[i].Y = (i * 53) % 240;
+	}
+	COST("Draw_Pixels 256 scattered", ILI9341_Draw_Pixels(points, 256, BLACK));
+	for(uint32_t i = 0; i < 256; i++)
+	{
+		points[i].X = 32 + i;
+		points[i].Y = 20;
+	}
+	COST("Draw_Pixels 256 in a row", ILI9341_Draw_Pixels(points, 256, BLACK));
+	COST("Draw_Horizontal_Line 320", ILI9341_Draw_Horizontal_Line(0, 120, 320, RED));
+	COST("Draw_Vertical_Line 240", ILI9341_Draw_Vertical_Line(160, 0, 240, RED));
+	COST("Draw_Rectangle 16x16", ILI9341_Draw_Rectangle(10, 10, 16, 16, BLUE));
+	COST("Draw_Rectangle 100x100", ILI9341_Draw_Rectangle(10, 10, 100, 100, BLUE));
+	COST("Draw_Hollow_Rectangle 100x100", ILI9341_Draw_Hollow_Rectangle_Coord(10, 10, 110, 110, BLACK));
+	COST("Draw_Hollow_Circle r=10", ILI9341_Draw_Hollow_Circle(160, 120, 10, GREEN));
+	COST("Draw_Hollow_Circle r=60", ILI9341_Draw_Hollow_Circle(160, 120, 60, GREEN));
+	COST("Draw_Filled_Circle r=10", ILI9341_Draw_Filled_Circle(160, 120, 10, GREEN));
+	COST("Draw_Filled_Circle r=60", ILI9341_Draw_Filled_Circle(160, 120, 60, GREEN));
+	COST("Draw_Char size 1", ILI9341_Draw_Char('A', 10, 10, BLACK, 1, WHITE));
+	COST("Draw_Char size 2", ILI9341_Draw_Char('A', 10, 10, BLACK, 2, WHITE));
+	COST("Draw_Text 20 chars size 1", ILI9341_Draw_Text("The quick brown fox.", 10, 10, BLACK, 1, WHITE));
+	COST("Draw_Text 20 chars size 2", ILI9341_Draw_Text("The quick brown fox.", 10, 10, BLACK, 2, WHITE));
+	COST("Draw_Bitmap 64x64", ILI9341_Draw_Bitmap(10, 10, 64, 64, snow_tiger, 320*2));
+	COST("Draw_Image 320x240", ILI9341_Draw_Image((const char*)snow_tiger, SCREEN_VERTICAL_2));
+
+	return 0;
+}
@@ -0,0 +1,117 @@
+/*
+ * host_demo.c
+ *
+ *  Runs the main.c demo screens against the simulated panel and saves a PPM
+ *  screenshot of each, with the bus traffic it took to draw it.
+ *
+ *  Usage: host_demo [output directory]
+ */
+
+#include <stdio.h>
+#include "ILI9341.h"
+#include "ILI9341_GFX.h"
+#include "sim_panel.h"
+#include "snow_tiger.h"
+
+static const char* out_dir = "out";
+
+/**
+ * @brief  xorshift32, stands in for HAL_RNG_GetRandomNumber with a fixed seed.
+ */
+static uint32_t Demo_Random(void)
+{
+	static uint32_t state = 2463534242u;
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+/**
+ * @brief  Waits for the bus, saves the screen and prints the traffic since the last screen.
+ */
+static void Demo_Screen(const char* Name)
+{
+	char path[256];
+	Sim_Stats_TypeDef stats;
+	static uint64_t start_ns;
+
+	ILI9341_Wait_Idle();
+	Sim_Get_Stats(&stats);
+	snprintf(path, sizeof(path), "%s/%s.ppm", out_dir, Name);
+	if(Sim_Save_PPM(path) != 0)
+	{
+		fprintf(stderr, "cannot write %s\n", path);
+	}
+	printf("%-10s %9.3f ms %9llu bytes %8llu command bytes %8llu CS toggles %8llu pixels\n", Name,
+		   (Sim_Time_ns() - start_ns) / 1e6, (unsigned long long)stats.Bytes,
+		   (unsigned long long)stats.Command_Bytes, (unsigned long long)stats.CS_Toggles,
+		   (unsigned long long)stats.Pixels);
+	if(stats.Errors != 0)
+	{
+		printf("%-10s %llu bytes sent with CS high\n", Name, (unsigned long long)stats.Errors);
+	}
+	Sim_Reset_Stats();
+	start_ns = Sim_Time_ns();
+}
+
+int main(int argc, char** argv)
+{
+	char Temp_Buffer_text[40];
+
+	if(argc > 1) out_dir = argv[1];
+	Sim_Init();
+
+	ILI9341_Init();
+	Demo_Screen("init");
+
+	ILI9341_Fill_Screen(WHITE);
+	ILI9341_Set_Rotation(SCREEN_HORIZONTAL_2);
+	ILI9341_Draw_Text("FPS TEST, 40 loop 2 screens", 10, 10, BLACK, 1, WHITE);
+	Demo_Screen("fps_text");
+
+	ILI9341_Fill_Screen(WHITE);
+	for(uint16_t i = 0; i <= 10; i++)
+	{
+		sprintf(Temp_Buffer_text, "Counting: %d", i);
+		ILI9341_Draw_Text(Temp_Buffer_text, 10, 10, BLACK, 2, WHITE);
+		ILI9341_Draw_Text(Temp_Buffer_text, 10, 30, BLUE, 2, WHITE);
+		ILI9341_Draw_Text(Temp_Buffer_text, 10, 50, RED, 2, WHITE);
+		ILI9341_Draw_Text(Temp_Buffer_text, 10, 70, GREEN, 2, WHITE);
+		ILI9341_Draw_Text(Temp_Buffer_text, 10, 90, BLACK, 2, WHITE);
+		ILI9341_Draw_Text(Temp_Buffer_text, 10, 110, BLUE, 2, WHITE);
+		ILI9341_Draw_Text(Temp_Buffer_text, 10, 130, RED, 2, WHITE);
+		ILI9341_Draw_Text(Temp_Buffer_text, 10, 150, GREEN, 2, WHITE);
+		ILI9341_Draw_Text(Temp_Buffer_text, 10, 170, WHITE, 2, BLACK);
+		ILI9341_Draw_Text(Temp_Buffer_text, 10, 190, BLUE, 2, BLACK);
+		ILI9341_Draw_Text(Temp_Buffer_text, 10, 210, RED, 2, BLACK);
+	}
+	Demo_Screen("counting");
+
+	ILI9341_Fill_Screen(WHITE);
+	for(uint32_t i = 0; i < 3000; i++)
+	{
+		uint16_t xr = Demo_Random() & 0x01FF;
+		uint16_t yr = Demo_Random() & 0x01FF;
+		uint16_t radiusr = Demo_Random() & 0x001F;
+		uint16_t colourr = Demo_Random();
+		ILI9341_Draw_Hollow_Circle(xr, yr, radiusr*2, colourr);
+	}
+	Demo_Screen("circles");
+
+	ILI9341_Fill_Screen(WHITE);
+	ILI9341_Draw_Filled_Circle(80, 120, 60, RED);
+	ILI9341_Draw_Filled_Circle(310, 230, 40, MAGENTA);
+	ILI9341_Draw_Hollow_Circle(220, 120, 60, DARKGREEN);
+	ILI9341_Draw_Rectangle(150, 180, 60, 30, NAVY);
+	ILI9341_Draw_Hollow_Rectangle_Coord(20, 150, 80, 200, BLACK);
+	ILI9341_Draw_Horizontal_Line(0, 235, 320, BLACK);
+	ILI9341_Draw_Vertical_Line(5, 0, 240, BLACK);
+	ILI9341_Draw_Text("Shapes", 250, 10, BLACK, 2, WHITE);
+	Demo_Screen("shapes");
+
+	ILI9341_Draw_Image((const char*)snow_tiger, SCREEN_VERTICAL_2);
+	Demo_Screen("tiger");
+
+	return 0;
+}
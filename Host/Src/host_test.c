@@ -0,0 +1,531 @@
+/*
+ * host_test.c
+ *
+ *  Draws known content through the driver and compares the simulated panel
+ *  against the expected pixels. Built with ILI9341_INDEXED=1 so the 8bpp
+ *  paths are covered too.
+ *
+ *  Usage: host_test, exits with 1 when a check fails
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "ILI9341.h"
+#include "ILI9341_GFX.h"
+#include "ILI9341_Band.h"
+#include "ILI9341_Image.h"
+#include "ILI9341_Indexed.h"
+#include "ILI9341_Memory.h"
+#include "sim_panel.h"
+
+#define TEST_IMAGE_WIDTH	100
+#define TEST_IMAGE_HEIGHT	80
+
+static uint8_t	test_image[TEST_IMAGE_WIDTH*TEST_IMAGE_HEIGHT*2];	//RGB565, high byte first
+static uint8_t	test_qoi[TEST_IMAGE_WIDTH*TEST_IMAGE_HEIGHT*3];		//worst case, one RGB op per pixel
+static uint32_t	test_qoi_size;
+static uint32_t	test_qoi_row[TEST_IMAGE_HEIGHT];	//offset of the first op of each row
+static uint8_t	test_index8[TEST_IMAGE_WIDTH*TEST_IMAGE_HEIGHT];
+static uint8_t	test_index4[(TEST_IMAGE_WIDTH + 1)/2*TEST_IMAGE_HEIGHT];
+static uint16_t	test_palette[256];
+static uint16_t	test_reference[SIM_GRAM_HEIGHT][SIM_GRAM_WIDTH];	//panel drawn in direct mode
+static uint16_t	test_scene[SIM_GRAM_HEIGHT][SIM_GRAM_WIDTH];		//second direct-mode snapshot
+static uint16_t	test_mask[SIM_GRAM_HEIGHT][SIM_GRAM_WIDTH];		//WHITE where a sub-rectangle was invalidated
+static uint32_t	test_failures;
+
+/**
+ * @brief  Colour of a pixel of the test image, unique for every position.
+ */
+static uint16_t Test_Image_Colour(uint16_t X, uint16_t Y)
+{
+	return (uint16_t)((Y << 8) ^ (X * 37) ^ 0x5A5A);
+}
+
+static void Test_Make_Image(void)
+{
+	for(uint16_t y = 0; y < TEST_IMAGE_HEIGHT; y++)
+	{
+		for(uint16_t x = 0; x < TEST_IMAGE_WIDTH; x++)
+		{
+			uint16_t colour = Test_Image_Colour(x, y);
+			test_image[(y*TEST_IMAGE_WIDTH + x)*2] = colour >> 8;
+			test_image[(y*TEST_IMAGE_WIDTH + x)*2 + 1] = colour;
+		}
+	}
+}
+
+/**
+ * @brief  Encodes the test image as QOI565 (RGB and RUN ops) and as INDEX8/INDEX4 of a 256 colour palette.
+ */
+static void Test_Make_Encoded(void)
+{
+	uint8_t* qoi = test_qoi;
+	uint16_t previous = 0;
+	uint8_t run = 0;
+
+	for(uint16_t i = 0; i < 256; i++)
+	{
+		test_palette[i] = (uint16_t)(i * 0x0101 ^ 0x1234);
+	}
+	for(uint16_t y = 0; y < TEST_IMAGE_HEIGHT; y++)
+	{
+		for(uint16_t x = 0; x < TEST_IMAGE_WIDTH; x++)
+		{
+			uint16_t colour = Test_Image_Colour(x / 6, y);	//runs of 6
+			uint8_t index = (x / 3 + y * 7) & 0xFF;
+
+			if((colour == previous) && (run < 62))
+			{
+				run++;
+			}
+			else
+			{
+				if(run != 0) *qoi++ = 0xC0 | (run - 1);
+				run = 0;
+				if(x == 0) test_qoi_row[y] = qoi - test_qoi;	//every row starts with a new colour
+				if(colour == previous)
+				{
+					run = 1;
+				}
+				else
+				{
+					*qoi++ = 0xFE;
+					*qoi++ = colour >> 8;
+					*qoi++ = colour;
+				}
+			}
+			previous = colour;
+			test_index8[y*TEST_IMAGE_WIDTH + x] = index;
+			if(index >= 16) index &= 0x0F;
+			test_index4[y*((TEST_IMAGE_WIDTH + 1)/2) + x/2] |= (x & 1) ? index : (index << 4);
+		}
+	}
+	if(run != 0) *qoi++ = 0xC0 | (run - 1);
+	test_qoi_size = qoi - test_qoi;
+}
+
+/**
+ * @brief  Compares the whole panel against Expected(X, Y), reports the first mismatch.
+ */
+static void Test_Check(const char* Name, uint16_t (*Expected)(uint16_t X, uint16_t Y))
+{
+	uint32_t bad = 0;
+
+	ILI9341_Wait_Idle();
+	for(uint16_t y = 0; y < SIM_GRAM_HEIGHT; y++)
+	{
+		for(uint16_t x = 0; x < SIM_GRAM_WIDTH; x++)
+		{
+			uint16_t want = Expected(x, y);
+			uint16_t got = Sim_Get_Pixel(x, y);
+			if(got == want) continue;
+			if(bad == 0)
+			{
+				printf("%s: pixel (%u,%u) is 0x%04X, expected 0x%04X\n", Name, x, y, got, want);
+			}
+			bad++;
+		}
+	}
+	printf("%-24s %s", Name, (bad == 0) ? "ok\n" : "FAILED");
+	if(bad != 0)
+	{
+		printf(" (%lu pixels)\n", (unsigned long)bad);
+		test_failures++;
+	}
+}
+
+/*40x30 crop at (10,5) of the test image, drawn at (20,30) on white*/
+static uint16_t Test_Expected_Crop(uint16_t X, uint16_t Y)
+{
+	if((X >= 20) && (X < 60) && (Y >= 30) && (Y < 60))
+	{
+		return Test_Image_Colour(X - 20 + 10, Y - 30 + 5);
+	}
+	return WHITE;
+}
+
+/*Whole test image drawn at (-30,-20) and at (200,290), clipped by the screen edges*/
+static uint16_t Test_Expected_Clipped(uint16_t X, uint16_t Y)
+{
+	if((X < 70) && (Y < 60))
+	{
+		return Test_Image_Colour(X + 30, Y + 20);
+	}
+	if((X >= 200) && (Y >= 290))
+	{
+		return Test_Image_Colour(X - 200, Y - 290);
+	}
+	return WHITE;
+}
+
+static void Test_Bitmap(void)
+{
+	ILI9341_Fill_Screen(WHITE);
+	ILI9341_Draw_Bitmap(20, 30, 40, 30, &test_image[(5*TEST_IMAGE_WIDTH + 10)*2], TEST_IMAGE_WIDTH);
+	Test_Check("bitmap_crop", Test_Expected_Crop);
+
+	ILI9341_Fill_Screen(WHITE);
+	ILI9341_Draw_Bitmap(-30, -20, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, test_image, TEST_IMAGE_WIDTH);
+	ILI9341_Draw_Bitmap(200, 290, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, test_image, TEST_IMAGE_WIDTH);
+	Test_Check("bitmap_clipped", Test_Expected_Clipped);
+}
+
+/**
+ * @brief  Default palette colour of the entry an RGB565 colour maps to, see ILI9341_Indexed_Reset_Palette.
+ */
+static uint16_t Test_Quantise(uint16_t Colour)
+{
+	uint8_t i = ILI9341_INDEX(Colour);
+	return (((i >> 5) * 31 / 7) << 11) | ((((i >> 2) & 0x07) * 63 / 7) << 5) | ((i & 0x03) * 31 / 3);
+}
+
+static void Test_Snapshot(uint16_t (*Buffer)[SIM_GRAM_WIDTH])
+{
+	ILI9341_Wait_Idle();
+	for(uint16_t y = 0; y < SIM_GRAM_HEIGHT; y++)
+	{
+		for(uint16_t x = 0; x < SIM_GRAM_WIDTH; x++)
+		{
+			Buffer[y][x] = Sim_Get_Pixel(x, y);
+		}
+	}
+}
+
+static void Test_Save_Reference(void)
+{
+	Test_Snapshot(test_reference);
+}
+
+static uint16_t Test_Expected_Quantised(uint16_t X, uint16_t Y)
+{
+	return Test_Quantise(test_reference[Y][X]);
+}
+
+/*Draws an image in direct mode, then through the framebuffer, and compares*/
+static void Test_Image_Indexed(const char* Name, const ILI9341_Image_TypeDef* Image, int16_t X, int16_t Y)
+{
+	ILI9341_Fill_Screen(WHITE);
+	ILI9341_Image_Draw(Image, X, Y);
+	Test_Save_Reference();
+
+	ILI9341_Set_Render_Mode(ILI9341_RENDER_INDEXED);
+	ILI9341_Fill_Screen(ILI9341_INDEX(WHITE));
+	ILI9341_Image_Draw(Image, X, Y);
+	ILI9341_Indexed_Flush();
+	ILI9341_Set_Render_Mode(ILI9341_RENDER_DIRECT);
+	Test_Check(Name, Test_Expected_Quantised);
+}
+
+static void Test_Indexed(void)
+{
+	const ILI9341_Image_TypeDef qoi = {TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, ILI9341_IMAGE_QOI565, test_qoi_size, test_qoi, NULL};
+	const ILI9341_Image_TypeDef index8 = {TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, ILI9341_IMAGE_INDEX8, sizeof(test_index8), test_index8, test_palette};
+	const ILI9341_Image_TypeDef index4 = {TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, ILI9341_IMAGE_INDEX4, sizeof(test_index4), test_index4, test_palette};
+	Sim_Stats_TypeDef stats;
+
+	Test_Image_Indexed("indexed_qoi565", &qoi, -17, 250);
+	Test_Image_Indexed("indexed_index8", &index8, 160, -9);
+	Test_Image_Indexed("indexed_index4", &index4, 31, 100);
+
+	//two bursts into one window, the second continues where the first stopped
+	ILI9341_Fill_Screen(WHITE);
+	ILI9341_Set_Address(30, 40, 39, 49);
+	ILI9341_Draw_Colour_Burst(RED, 55);
+	ILI9341_Draw_Colour_Burst(BLUE, 45);
+	ILI9341_Draw_Pixel(100, 100, GREEN);
+	Test_Save_Reference();
+	ILI9341_Set_Render_Mode(ILI9341_RENDER_INDEXED);
+	ILI9341_Fill_Screen(ILI9341_INDEX(WHITE));
+	ILI9341_Set_Address(30, 40, 39, 49);
+	ILI9341_Draw_Colour_Burst(ILI9341_INDEX(RED), 55);
+	ILI9341_Draw_Colour_Burst(ILI9341_INDEX(BLUE), 45);
+	ILI9341_Draw_Pixel(100, 100, ILI9341_INDEX(GREEN));
+	ILI9341_Indexed_Flush();
+	ILI9341_Set_Render_Mode(ILI9341_RENDER_DIRECT);
+	Test_Check("indexed_colour_burst", Test_Expected_Quantised);
+
+	//drawing into the framebuffer leaves the bus alone
+	ILI9341_Set_Render_Mode(ILI9341_RENDER_INDEXED);
+	ILI9341_Wait_Idle();
+	Sim_Reset_Stats();
+	ILI9341_Draw_Hollow_Circle(120, 160, 50, ILI9341_INDEX(RED));
+	ILI9341_Draw_Text("no bus", 10, 10, ILI9341_INDEX(BLACK), 2, ILI9341_INDEX(WHITE));
+	ILI9341_Set_Address(100, 200, 149, 219);
+	ILI9341_Draw_Colour_Burst(ILI9341_INDEX(GREEN), 700);
+	ILI9341_Draw_Colour(ILI9341_INDEX(BLUE));
+	Sim_Get_Stats(&stats);
+	ILI9341_Indexed_Flush();
+	ILI9341_Set_Render_Mode(ILI9341_RENDER_DIRECT);
+	printf("%-24s %s", "indexed_no_bus", ((stats.Bytes == 0) && (stats.CS_Toggles == 0)) ? "ok\n" : "FAILED");
+	if((stats.Bytes != 0) || (stats.CS_Toggles != 0))
+	{
+		printf(" (%llu bytes, %llu CS toggles)\n", (unsigned long long)stats.Bytes, (unsigned long long)stats.CS_Toggles);
+		test_failures++;
+	}
+}
+
+/*QOI565 stream cut after 40 rows, drawn at (50,60): the 40 complete rows, then nothing*/
+static uint16_t Test_Expected_Truncated(uint16_t X, uint16_t Y)
+{
+	if((X >= 50) && (X < 50 + TEST_IMAGE_WIDTH) && (Y >= 60) && (Y < 100))
+	{
+		return test_reference[Y][X];
+	}
+	return WHITE;
+}
+
+static void Test_Image_Errors(void)
+{
+	const ILI9341_Image_TypeDef qoi = {TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, ILI9341_IMAGE_QOI565, test_qoi_size, test_qoi, NULL};
+	const ILI9341_Image_TypeDef cut = {TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, ILI9341_IMAGE_QOI565, test_qoi_row[40], test_qoi, NULL};
+	const ILI9341_Image_TypeDef short_index8 = {TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, ILI9341_IMAGE_INDEX8, sizeof(test_index8) - 1, test_index8, test_palette};
+	uint8_t full, truncated, index8;
+
+	ILI9341_Fill_Screen(WHITE);
+	full = ILI9341_Image_Draw(&qoi, 50, 60);
+	Test_Save_Reference();
+	ILI9341_Fill_Screen(WHITE);
+	truncated = ILI9341_Image_Draw(&cut, 50, 60);
+	index8 = ILI9341_Image_Draw(&short_index8, 0, 0);
+	Test_Check("qoi565_truncated", Test_Expected_Truncated);
+	printf("%-24s %s", "image_status", ((full == ILI9341_IMAGE_OK) && (truncated == ILI9341_IMAGE_TRUNCATED) && (index8 == ILI9341_IMAGE_TRUNCATED)) ? "ok\n" : "FAILED");
+	if((full != ILI9341_IMAGE_OK) || (truncated != ILI9341_IMAGE_TRUNCATED) || (index8 != ILI9341_IMAGE_TRUNCATED))
+	{
+		printf(" (%u %u %u)\n", full, truncated, index8);
+		test_failures++;
+	}
+}
+
+/*INDEX8 image drawn at (0,0) after every palette entry was inverted in place*/
+static uint16_t Test_Expected_Palette_Edit(uint16_t X, uint16_t Y)
+{
+	if((X < TEST_IMAGE_WIDTH) && (Y < TEST_IMAGE_HEIGHT))
+	{
+		return ~test_palette[test_index8[Y*TEST_IMAGE_WIDTH + X]];
+	}
+	return WHITE;
+}
+
+static void Test_Palette_Edit(void)
+{
+	const ILI9341_Image_TypeDef index8 = {TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, ILI9341_IMAGE_INDEX8, sizeof(test_index8), test_index8, test_palette};
+
+	ILI9341_Fill_Screen(WHITE);
+	ILI9341_Image_Draw(&index8, 0, 0);
+	for(uint16_t i = 0; i < 256; i++)
+	{
+		test_palette[i] = ~test_palette[i];
+	}
+	ILI9341_Image_Invalidate_Palette();
+	ILI9341_Image_Draw(&index8, 0, 0);
+	for(uint16_t i = 0; i < 256; i++)
+	{
+		test_palette[i] = ~test_palette[i];
+	}
+	Test_Check("palette_edit", Test_Expected_Palette_Edit);
+	ILI9341_Image_Invalidate_Palette();
+}
+
+/**
+ * @brief  Draws a mixed scene, through the band renderer or with the direct ILI9341_Draw_xxx calls.
+ * @param  Band: 1 to record ILI9341_Band_xxx commands, 0 to draw directly.
+ * @param  Phase: Moves and relabels part of the scene, for a second frame.
+ *
+ * Rectangles and lines cross the right and bottom edges, the bitmap the left
+ * one; text is drawn at scale 1 and 2.
+ */
+static void Test_Scene(uint8_t Band, uint8_t Phase)
+{
+	int16_t w = LCD_WIDTH;
+	int16_t h = LCD_HEIGHT;
+	const char* label = Phase ? "Band 456" : "Band 123";
+	const uint8_t* crop = &test_image[(5*TEST_IMAGE_WIDTH + 10)*2];
+
+	if(Band)
+	{
+		ILI9341_Band_Fill_Rect(10, 10, 100, 60, BLUE);
+		ILI9341_Band_Fill_Rect(w - 30, h - 20, 80, 50, GREEN);
+		ILI9341_Band_Fill_Rect(0, 75, w, 1, RED);
+		ILI9341_Band_Fill_Rect(150, 0, 1, h, BLACK);
+		ILI9341_Band_Hollow_Circle(60 + Phase*20, 140, 40, MAGENTA);
+		ILI9341_Band_Filled_Circle(w - 20, 30, 35, ORANGE);
+		ILI9341_Band_Bitmap(-15, h - 50, 40, 30, crop, TEST_IMAGE_WIDTH);
+		ILI9341_Band_Text(label, 20, 100, BLACK, 2, YELLOW);
+		ILI9341_Band_Text("edge", w - 12, h/2, NAVY, 1, CYAN);
+		ILI9341_Band_Pixel(5, 5, RED);
+		ILI9341_Band_Pixel(w - 1, h - 1, BLUE);
+		ILI9341_Band_Pixel(70 + Phase, 120, PURPLE);
+	}
+	else
+	{
+		ILI9341_Draw_Rectangle(10, 10, 100, 60, BLUE);
+		ILI9341_Draw_Rectangle(w - 30, h - 20, 80, 50, GREEN);
+		ILI9341_Draw_Horizontal_Line(0, 75, w, RED);
+		ILI9341_Draw_Vertical_Line(150, 0, h, BLACK);
+		ILI9341_Draw_Hollow_Circle(60 + Phase*20, 140, 40, MAGENTA);
+		ILI9341_Draw_Filled_Circle(w - 20, 30, 35, ORANGE);
+		ILI9341_Draw_Bitmap(-15, h - 50, 40, 30, crop, TEST_IMAGE_WIDTH);
+		ILI9341_Draw_Text(label, 20, 100, BLACK, 2, YELLOW);
+		ILI9341_Draw_Text("edge", w - 12, h/2, NAVY, 1, CYAN);
+		ILI9341_Draw_Pixel(5, 5, RED);
+		ILI9341_Draw_Pixel(w - 1, h - 1, BLUE);
+		ILI9341_Draw_Pixel(70 + Phase, 120, PURPLE);
+	}
+}
+
+/*First scene everywhere, the second one inside the invalidated sub-rectangle*/
+static uint16_t Test_Expected_Band(uint16_t X, uint16_t Y)
+{
+	return (test_mask[Y][X] == WHITE) ? test_scene[Y][X] : test_reference[Y][X];
+}
+
+/**
+ * @brief  Checks that ILI9341_Band_End repaints exactly what the direct calls draw, in every rotation.
+ *
+ * Frame 1 repaints the whole screen; frame 2 changes the scene but only
+ * invalidates a sub-rectangle, so outside it the panel must keep frame 1.
+ */
+static void Test_Band(void)
+{
+	static const char* const names[4] = {"band_vertical_1", "band_horizontal_1", "band_vertical_2", "band_horizontal_2"};
+
+	for(uint8_t rotation = SCREEN_VERTICAL_1; rotation <= SCREEN_HORIZONTAL_2; rotation++)
+	{
+		ILI9341_Set_Rotation(rotation);
+
+		//direct: both scenes and the sub-rectangle, as panel snapshots
+		ILI9341_Fill_Screen(WHITE);
+		Test_Scene(0, 0);
+		Test_Save_Reference();
+		ILI9341_Fill_Screen(WHITE);
+		Test_Scene(0, 1);
+		Test_Snapshot(test_scene);
+		ILI9341_Fill_Screen(BLACK);
+		ILI9341_Draw_Rectangle(40, 90, 120, 100, WHITE);
+		Test_Snapshot(test_mask);
+
+		ILI9341_Fill_Screen(RED);
+		ILI9341_Band_Begin(WHITE);
+		ILI9341_Band_Invalidate_All();
+		Test_Scene(1, 0);
+		ILI9341_Band_End();
+		ILI9341_Band_Begin(WHITE);
+		ILI9341_Band_Invalidate(40, 90, 120, 100);
+		Test_Scene(1, 1);
+		ILI9341_Band_End();
+		Test_Check(names[rotation], Test_Expected_Band);
+	}
+	ILI9341_Set_Rotation(SCREEN_VERTICAL_1);
+}
+
+/**
+ * @brief  Reports one named condition, counted as a failure when false.
+ */
+static void Test_Expect(const char* Name, uint8_t Condition)
+{
+	printf("%-24s %s\n", Name, Condition ? "ok" : "FAILED");
+	if(!Condition) test_failures++;
+}
+
+/*Scratch pools: alignment, marks, refused misuse; built with 1024 and 512 byte pools*/
+static void Test_Memory(void)
+{
+	ILI9341_Mem_Stats_TypeDef stats;
+	uint32_t cpu_start = ILI9341_Mem_Mark(ILI9341_MEM_CPU);
+	uint8_t* a = ILI9341_Mem_Alloc(ILI9341_MEM_CPU, 3);
+	uint8_t* b = ILI9341_Mem_Alloc(ILI9341_MEM_CPU, 5);
+	uint32_t mark = ILI9341_Mem_Mark(ILI9341_MEM_CPU);
+	uint8_t* c = ILI9341_Mem_Alloc(ILI9341_MEM_CPU, 100);
+	uint8_t* d = ILI9341_Mem_Alloc(ILI9341_MEM_DMA, 6);
+	uint32_t dma_mark = ILI9341_Mem_Mark(ILI9341_MEM_DMA);
+
+	Test_Expect("mem_alloc_aligned", (a != NULL) && (b == a + 4) && (c == b + 8) && (d != NULL)
+		&& ((((uintptr_t)a | (uintptr_t)b | (uintptr_t)c | (uintptr_t)d) & 3) == 0));
+
+	Test_Expect("mem_release_to_mark", ILI9341_Mem_Release(ILI9341_MEM_CPU, mark)
+		&& (ILI9341_Mem_Alloc(ILI9341_MEM_CPU, 1) == c));
+
+	//a DMA mark on the CPU pool, the stale mark above the top after releasing to the start
+	ILI9341_Mem_Release(ILI9341_MEM_CPU, cpu_start);
+	Test_Expect("mem_release_misuse", !ILI9341_Mem_Release(ILI9341_MEM_CPU, dma_mark)
+		&& !ILI9341_Mem_Release(ILI9341_MEM_CPU, mark)
+		&& (ILI9341_Mem_Alloc(ILI9341_MEM_CPU, 4) == a));
+
+	Test_Expect("mem_alloc_limits", (ILI9341_Mem_Alloc(ILI9341_MEM_CPU, 1021) == NULL)
+		&& (ILI9341_Mem_Alloc(ILI9341_MEM_CPU, UINT32_MAX) == NULL)
+		&& (ILI9341_Mem_Alloc(ILI9341_MEM_REGIONS, 4) == NULL)
+		&& (ILI9341_Mem_Alloc(ILI9341_MEM_CPU, 1020) != NULL));
+
+	ILI9341_Mem_Get_Stats(ILI9341_MEM_CPU, &stats);
+	Test_Expect("mem_stats", (stats.Size == 1024) && (stats.Used == 1024) && (stats.Peak == 1024)
+		&& (stats.Failures == 2) && (stats.Bad_Releases == 2));
+	ILI9341_Mem_Release(ILI9341_MEM_CPU, 0);
+	ILI9341_Mem_Release(ILI9341_MEM_DMA, 0);
+}
+
+static uint16_t Test_Expected_White(uint16_t X, uint16_t Y)
+{
+	return WHITE;
+}
+
+/*With every transfer buffer held by the application, the buffered drawings give up cleanly*/
+static void Test_No_Buffer(void)
+{
+	const ILI9341_Image_TypeDef qoi = {TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, ILI9341_IMAGE_QOI565, test_qoi_size, test_qoi, NULL};
+	const ILI9341_Image_TypeDef index4 = {TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, ILI9341_IMAGE_INDEX4, sizeof(test_index4), test_index4, test_palette};
+	uint8_t* held[ILI9341_TRANSFER_BUFFERS];
+	uint8_t status[2];
+	uint8_t last_free;
+
+	ILI9341_Fill_Screen(WHITE);
+	ILI9341_Set_Render_Mode(ILI9341_RENDER_INDEXED);
+	ILI9341_Fill_Screen(ILI9341_INDEX(WHITE));
+	ILI9341_Indexed_Flush();
+	ILI9341_Draw_Rectangle(10, 10, 20, 20, ILI9341_INDEX(RED));	//left dirty
+	ILI9341_Set_Render_Mode(ILI9341_RENDER_DIRECT);
+	for(uint8_t i = 0; i < ILI9341_TRANSFER_BUFFERS; i++)
+	{
+		held[i] = ILI9341_Acquire_Buffer();
+	}
+	last_free = (held[ILI9341_TRANSFER_BUFFERS - 1] != NULL);
+
+	ILI9341_Draw_Text("held", 10, 100, BLACK, 2, YELLOW);
+	status[0] = ILI9341_Image_Draw(&qoi, 0, 150);
+	status[1] = ILI9341_Image_Draw(&index4, 100, 150);
+	ILI9341_Set_Render_Mode(ILI9341_RENDER_INDEXED);
+	ILI9341_Indexed_Flush();
+	ILI9341_Set_Render_Mode(ILI9341_RENDER_DIRECT);
+	Test_Check("no_buffer_nothing_drawn", Test_Expected_White);
+	Test_Expect("no_buffer_status", last_free && (status[0] == ILI9341_IMAGE_NO_BUFFER) && (status[1] == ILI9341_IMAGE_NO_BUFFER));
+
+	//once a buffer is back, the dirty rows left by the refused flush go out
+	for(uint8_t i = 0; i < ILI9341_TRANSFER_BUFFERS; i++)
+	{
+		ILI9341_Release_Buffer(held[i]);
+	}
+	ILI9341_Set_Render_Mode(ILI9341_RENDER_INDEXED);
+	ILI9341_Indexed_Flush();
+	ILI9341_Set_Render_Mode(ILI9341_RENDER_DIRECT);
+	ILI9341_Wait_Idle();
+	Test_Expect("no_buffer_flush_later", Sim_Get_Pixel(15, 15) == RED);
+}
+
+int main(void)
+{
+	Sim_Init();
+	ILI9341_Init();
+	ILI9341_Set_Rotation(SCREEN_VERTICAL_1);
+	Test_Make_Image();
+	Test_Make_Encoded();
+
+	Test_Bitmap();
+	Test_Indexed();
+	Test_Image_Errors();
+	Test_Palette_Edit();
+	Test_Band();
+	Test_Memory();
+	Test_No_Buffer();
+
+	printf("%lu failed\n", (unsigned long)test_failures);
+	return (test_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,474 @@
+/*
+ * sim_panel.c
+ *
+ *  Host implementation of the HAL calls used by the ILI9341 driver, backed by
+ *  a simulated panel.
+ *
+ *  Every byte clocked out while CS is low goes through a small command decoder:
+ *  DC low starts a command, DC high bytes are its parameters. Column (0x2A) and
+ *  page (0x2B) address set, memory write (0x2C) and memory access control
+ *  (0x36, MX/MY/MV) are interpreted, so pixel data lands in GRAM the same way
+ *  it does on the controller. The power mode read (0x0A) follows software
+ *  reset, sleep out and display on.
+ *
+ *  DMA transfers complete synchronously: HAL_SPI_Transmit_DMA clocks the data
+ *  and calls HAL_SPI_TxCpltCallback before returning, which drives the same
+ *  chaining code as the SPI2 TX interrupt on target.
+ *
+ *  Time is modelled, not measured: every frame costs its bit time at the SPI2
+ *  clock (APB1 / BaudRatePrescaler, 21 Mbit/s by default) and each HAL call,
+ *  GPIO write and DMA request/interrupt adds the overhead set in
+ *  Sim_Timing_TypeDef. The defaults are estimates for the F407 at 168 MHz
+ *  with -O2; calibrate them with the DWT figures measured on target.
+ *  CPU work between HAL calls is not charged, and a DMA transfer is treated
+ *  as blocking, which matches the driver as soon as the next call waits for
+ *  the bus.
+ *
+ *  Set SIM_TRACE=<file> to log every byte as C<hex> (command) or d<hex> (data).
+ *  Set SIM_TIMING=<field>=<value>,... to override the cost model, for example
+ *  SIM_TIMING=GPIO_Write_ns=80,Transmit_Call_ns=1200.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "main.h"
+#include "sim_panel.h"
+
+static Sim_Timing_TypeDef timing =
+{
+	.APB1_Hz = 42000000,
+	.Frame_Gap_ns = 0,
+	.GPIO_Write_ns = 60,
+	.Transmit_Call_ns = 1500,
+	.DMA_Start_ns = 2500,
+	.DMA_Complete_ns = 1500,
+	.SPI_Init_ns = 2000,
+	.DMA_Init_ns = 2000,
+	.Tick_Poll_ns = 1000,
+};
+
+GPIO_TypeDef		Sim_GPIOD;
+DWT_Type			Sim_DWT;
+CoreDebug_Type		Sim_CoreDebug;
+uint32_t			SystemCoreClock = 168000000;
+
+SPI_HandleTypeDef	hspi2;
+DMA_HandleTypeDef	hdma_spi2_tx;
+static SPI_TypeDef	sim_spi2;
+
+/*Bus and decoder state*/
+static uint8_t		cs = 1;
+static uint8_t		dc = 1;
+static uint8_t		command;
+static uint8_t		params[4];
+static uint8_t		param_count;
+static uint16_t		column_start, column_end, page_start, page_end;
+static uint16_t		column, page;
+static uint8_t		madctl;
+static uint8_t		power_mode = 0x08;
+static uint8_t		high_byte;
+static uint8_t		have_high_byte;
+
+static uint16_t				gram[SIM_GRAM_HEIGHT][SIM_GRAM_WIDTH];
+static Sim_Stats_TypeDef	stats;
+static uint64_t				now_ps;				//simulated time, picoseconds
+static uint64_t				wire_ps;			//time the SPI clock was running
+static uint64_t				measure_start_ps;
+static uint64_t				measure_wire_ps;
+static Sim_Stats_TypeDef	measure_start;
+static FILE*				trace;
+
+/*Fields settable from SIM_TIMING*/
+static const struct
+{
+	const char*	Name;
+	uint32_t*	Value;
+} timing_fields[] =
+{
+	{"APB1_Hz", &timing.APB1_Hz},
+	{"Frame_Gap_ns", &timing.Frame_Gap_ns},
+	{"GPIO_Write_ns", &timing.GPIO_Write_ns},
+	{"Transmit_Call_ns", &timing.Transmit_Call_ns},
+	{"DMA_Start_ns", &timing.DMA_Start_ns},
+	{"DMA_Complete_ns", &timing.DMA_Complete_ns},
+	{"SPI_Init_ns", &timing.SPI_Init_ns},
+	{"DMA_Init_ns", &timing.DMA_Init_ns},
+	{"Tick_Poll_ns", &timing.Tick_Poll_ns},
+};
+
+/**
+ * @brief  Applies a "Field=value,Field=value" override list to the cost model.
+ */
+static void Sim_Parse_Timing(const char* Text)
+{
+	while(*Text != '\0')
+	{
+		size_t length = strcspn(Text, "=");
+		uint32_t i;
+
+		for(i = 0; i < sizeof(timing_fields)/sizeof(timing_fields[0]); i++)
+		{
+			if((strlen(timing_fields[i].Name) == length) && (strncmp(Text, timing_fields[i].Name, length) == 0)) break;
+		}
+		if((Text[length] != '=') || (i == sizeof(timing_fields)/sizeof(timing_fields[0])))
+		{
+			fprintf(stderr, "SIM_TIMING: unknown field '%.*s'\n", (int)length, Text);
+			return;
+		}
+		*timing_fields[i].Value = strtoul(Text + length + 1, NULL, 0);
+		Text += length + 1 + strcspn(Text + length + 1, ",");
+		if(*Text == ',') Text++;
+	}
+}
+
+/**
+ * @brief  Advances simulated time and the DWT cycle counter.
+ */
+static void Sim_Advance_ps(uint64_t Picoseconds)
+{
+	now_ps += Picoseconds;
+	Sim_DWT.CYCCNT = (uint32_t)(now_ps * (SystemCoreClock / 1000000) / 1000000);
+}
+
+static void Sim_Advance(uint64_t Nanoseconds)
+{
+	Sim_Advance_ps(Nanoseconds * 1000);
+}
+
+/**
+ * @brief  Time to clock one frame of the given handle, from APB1 and the baud rate prescaler.
+ */
+static uint64_t Sim_Frame_ps(SPI_HandleTypeDef* Handle)
+{
+	uint32_t divider = 2u << (Handle->Init.BaudRatePrescaler >> 3);
+	uint32_t bits = (Handle->Init.DataSize == SPI_DATASIZE_16BIT) ? 16 : 8;
+	return (uint64_t)bits * divider * 1000000000000ull / timing.APB1_Hz;
+}
+
+/**
+ * @brief  Writes one pixel at controller column/page, applying MADCTL like the ILI9341.
+ */
+static void Sim_Plot(int Column, int Page, uint16_t Colour)
+{
+	int mv = madctl & 0x20;
+	int x, y;
+
+	if(madctl & 0x40) Column = (mv ? SIM_GRAM_HEIGHT - 1 : SIM_GRAM_WIDTH - 1) - Column;	//MX
+	if(madctl & 0x80) Page = (mv ? SIM_GRAM_WIDTH - 1 : SIM_GRAM_HEIGHT - 1) - Page;		//MY
+	if(mv)
+	{
+		x = Page;
+		y = Column;
+	}
+	else
+	{
+		x = Column;
+		y = Page;
+	}
+	if((x < 0) || (x >= SIM_GRAM_WIDTH) || (y < 0) || (y >= SIM_GRAM_HEIGHT)) return;
+	gram[y][x] = Colour;
+	stats.Pixels++;
+}
+
+/**
+ * @brief  Feeds one byte clocked on the bus into the panel.
+ */
+static void Sim_Byte(uint8_t Byte)
+{
+	if(cs)
+	{
+		stats.Errors++;
+		return;
+	}
+	stats.Bytes++;
+	if(trace != NULL)
+	{
+		fprintf(trace, "%c%02X\n", dc ? 'd' : 'C', Byte);
+	}
+
+	if(!dc)
+	{
+		stats.Command_Bytes++;
+		command = Byte;
+		param_count = 0;
+		have_high_byte = 0;
+		if(Byte == 0x01) power_mode = 0x08;
+		if(Byte == 0x11) power_mode |= 0x90;
+		if(Byte == 0x29) power_mode |= 0x04;
+		if(Byte == 0x2C)
+		{
+			column = column_start;
+			page = page_start;
+		}
+		return;
+	}
+
+	switch(command)
+	{
+		case 0x2A:
+		case 0x2B:
+			if(param_count >= 4) break;
+			params[param_count++] = Byte;
+			if(param_count == 4)
+			{
+				uint16_t start = (params[0] << 8) | params[1];
+				uint16_t end = (params[2] << 8) | params[3];
+				if(command == 0x2A)
+				{
+					column_start = start;
+					column_end = end;
+				}
+				else
+				{
+					page_start = start;
+					page_end = end;
+				}
+			}
+			break;
+
+		case 0x36:
+			madctl = Byte;
+			break;
+
+		case 0x2C:
+			if(!have_high_byte)
+			{
+				high_byte = Byte;
+				have_high_byte = 1;
+				break;
+			}
+			have_high_byte = 0;
+			stats.Pixel_Bytes += 2;
+			Sim_Plot(column, page, (high_byte << 8) | Byte);
+			if(++column > column_end)
+			{
+				column = column_start;
+				if(++page > page_end) page = page_start;
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+/**
+ * @brief  Clocks SPI frames, 8 or 16 bits wide as configured (16-bit frames go MSB first).
+ */
+static void Sim_Frames(SPI_HandleTypeDef* Handle, const uint8_t* Data, uint16_t Count, int Increment, uint32_t Gap_ns)
+{
+	uint64_t frame_ps = Sim_Frame_ps(Handle);
+
+	for(uint32_t i = 0; i < Count; i++)
+	{
+		Sim_Advance_ps(frame_ps + (uint64_t)Gap_ns*1000);
+		wire_ps += frame_ps;
+		if(Handle->Init.DataSize == SPI_DATASIZE_16BIT)
+		{
+			uint16_t frame = ((const uint16_t*)Data)[Increment ? i : 0];
+			Sim_Byte(frame >> 8);
+			Sim_Byte(frame);
+		}
+		else
+		{
+			Sim_Byte(Data[Increment ? i : 0]);
+		}
+	}
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+	Sim_Advance(timing.GPIO_Write_ns);
+	if(GPIO_Pin & CHIP_SELECT_Pin)
+	{
+		if(cs != PinState) stats.CS_Toggles++;
+		cs = PinState;
+	}
+	if(GPIO_Pin & DC_Pin)
+	{
+		dc = PinState;
+	}
+	if(PinState) GPIOx->ODR |= GPIO_Pin;
+	else GPIOx->ODR &= ~GPIO_Pin;
+}
+
+HAL_StatusTypeDef HAL_SPI_Init(SPI_HandleTypeDef *hspi)
+{
+	stats.Reconfigurations++;
+	Sim_Advance(timing.SPI_Init_ns);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+	stats.Transfers++;
+	Sim_Advance(timing.Transmit_Call_ns);
+	Sim_Frames(hspi, pData, Size, 1, timing.Frame_Gap_ns);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+	memset(pData, 0, Size);
+	if((command == 0x0A) && (Size != 0)) pData[0] = power_mode;
+	Sim_Advance(timing.Transmit_Call_ns);
+	Sim_Advance_ps(Size * Sim_Frame_ps(hspi));
+	wire_ps += Size * Sim_Frame_ps(hspi);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size)
+{
+	stats.DMA_Transfers++;
+	Sim_Advance(timing.DMA_Start_ns);
+	Sim_Frames(hspi, pData, Size, hspi->hdmatx->Init.MemInc == DMA_MINC_ENABLE, 0);
+	Sim_Advance(timing.DMA_Complete_ns);
+	HAL_SPI_TxCpltCallback(hspi);
+	return HAL_OK;
+}
+
+__weak void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+}
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma)
+{
+	Sim_Advance(timing.DMA_Init_ns);
+	return HAL_OK;
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+	//the HAL adds one tick to guarantee the minimum wait
+	Sim_Advance((uint64_t)(Delay + 1) * 1000000);
+}
+
+uint32_t HAL_GetTick(void)
+{
+	Sim_Advance(timing.Tick_Poll_ns);
+	return (uint32_t)(now_ps / 1000000000);
+}
+
+void Error_Handler(void)
+{
+	fprintf(stderr, "Error_Handler\n");
+	exit(1);
+}
+
+/**
+ * @brief  Wires the SPI/DMA handles the way MX_SPI2_Init/HAL_SPI_MspInit do and clears the panel.
+ */
+void Sim_Init(void)
+{
+	hspi2.Instance = &sim_spi2;
+	hspi2.Init.DataSize = SPI_DATASIZE_8BIT;
+	hspi2.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_2;
+	hspi2.hdmatx = &hdma_spi2_tx;
+	hdma_spi2_tx.Init.MemInc = DMA_MINC_ENABLE;
+	hdma_spi2_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+	hdma_spi2_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+
+	memset(gram, 0, sizeof(gram));
+	memset(&stats, 0, sizeof(stats));
+	if((trace == NULL) && (getenv("SIM_TRACE") != NULL))
+	{
+		trace = fopen(getenv("SIM_TRACE"), "w");
+	}
+	if(getenv("SIM_TIMING") != NULL)
+	{
+		Sim_Parse_Timing(getenv("SIM_TIMING"));
+	}
+}
+
+void Sim_Get_Stats(Sim_Stats_TypeDef* Stats)
+{
+	*Stats = stats;
+}
+
+void Sim_Reset_Stats(void)
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
+uint64_t Sim_Time_ns(void)
+{
+	return now_ps / 1000;
+}
+
+void Sim_Get_Timing(Sim_Timing_TypeDef* Timing)
+{
+	*Timing = timing;
+}
+
+void Sim_Set_Timing(const Sim_Timing_TypeDef* Timing)
+{
+	timing = *Timing;
+}
+
+/**
+ * @brief  Starts measuring the cost of the following driver calls.
+ */
+void Sim_Measure_Start(void)
+{
+	measure_start = stats;
+	measure_start_ps = now_ps;
+	measure_wire_ps = wire_ps;
+}
+
+/**
+ * @brief  Reports the cost of everything since Sim_Measure_Start.
+ * @param  Cost: Destination.
+ *
+ * Call ILI9341_Wait_Idle first on target-like code paths; in the simulator DMA
+ * transfers are already finished when the call returns.
+ */
+void Sim_Measure_Stop(Sim_Cost_TypeDef* Cost)
+{
+	uint64_t bytes = stats.Bytes - measure_start.Bytes;
+	uint64_t elapsed_ps = now_ps - measure_start_ps;
+
+	Cost->Time_us = elapsed_ps / 1e6;
+	Cost->Bytes = bytes;
+	Cost->Command_Bytes = stats.Command_Bytes - measure_start.Command_Bytes;
+	Cost->Pixel_Bytes = stats.Pixel_Bytes - measure_start.Pixel_Bytes;
+	Cost->CS_Toggles = stats.CS_Toggles - measure_start.CS_Toggles;
+	Cost->Efficiency = bytes ? (double)Cost->Pixel_Bytes / bytes : 0.0;
+	Cost->Bus_Utilisation = elapsed_ps ? (double)(wire_ps - measure_wire_ps) / elapsed_ps : 0.0;
+}
+
+/**
+ * @brief  Reads a pixel as seen from the front of the panel (X 0..239, Y 0..319).
+ *
+ * The module scans GRAM columns right to left, so SCREEN_VERTICAL_1 (MX set)
+ * shows up the right way round.
+ */
+uint16_t Sim_Get_Pixel(uint16_t X, uint16_t Y)
+{
+	if((X >= SIM_GRAM_WIDTH) || (Y >= SIM_GRAM_HEIGHT)) return 0;
+	return gram[Y][SIM_GRAM_WIDTH - 1 - X];
+}
+
+/**
+ * @brief  Saves the panel as seen from the front as a binary PPM.
+ * @retval 0 on success, -1 when the file cannot be written.
+ */
+int Sim_Save_PPM(const char* Path)
+{
+	FILE* f = fopen(Path, "wb");
+	if(f == NULL) return -1;
+
+	fprintf(f, "P6\n%d %d\n255\n", SIM_GRAM_WIDTH, SIM_GRAM_HEIGHT);
+	for(uint16_t y = 0; y < SIM_GRAM_HEIGHT; y++)
+	{
+		for(uint16_t x = 0; x < SIM_GRAM_WIDTH; x++)
+		{
+			uint16_t v = Sim_Get_Pixel(x, y);
+			fputc((v >> 11) * 255 / 31, f);
+			fputc(((v >> 5) & 0x3F) * 255 / 63, f);
+			fputc((v & 0x1F) * 255 / 31, f);
+		}
+	}
+	fclose(f);
+	return 0;
+}
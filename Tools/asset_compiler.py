@@ -0,0 +1,407 @@
+#!/usr/bin/env python3
+"""
+asset_compiler.py - converts PNG/PPM images into C headers for the ILI9341 driver.
+
+Every output header declares the pixel data and an ILI9341_Image_TypeDef
+descriptor (see Core/Src/ILI9341_Image.h) with the real width, height, format
+and size, ready for ILI9341_Image_Draw.
+
+Encodings (-f):
+    rgb565      raw RGB565, high byte first (display order, ILI9341_IMAGE_RGB565)
+    rgb565le    raw RGB565, low byte first (uint16_t array for CPU-side use,
+                no descriptor)
+    index8      8 bpp indices plus palette (ILI9341_IMAGE_INDEX8)
+    index4      4 bpp indices plus palette, high nibble first, each row starts
+                on a byte boundary (ILI9341_IMAGE_INDEX4)
+    qoi565      compressed op stream (ILI9341_IMAGE_QOI565)
+
+Palettised encodings use the exact colours when the image has few enough,
+otherwise a median cut palette.
+
+Usage:
+    asset_compiler.py -f qoi565 -o Core/Src images/*.png
+    asset_compiler.py -f index4 --name logo logo.ppm
+
+Only the Python standard library is needed. Several inputs are converted in
+parallel on all CPU cores (-j to limit).
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import zlib
+from concurrent.futures import ProcessPoolExecutor
+
+FORMATS = ("rgb565", "rgb565le", "index8", "index4", "qoi565")
+
+FORMAT_IDS = {
+    "rgb565": "ILI9341_IMAGE_RGB565",
+    "qoi565": "ILI9341_IMAGE_QOI565",
+    "index8": "ILI9341_IMAGE_INDEX8",
+    "index4": "ILI9341_IMAGE_INDEX4",
+}
+
+
+# ---------------------------------------------------------------------------
+# Input
+# ---------------------------------------------------------------------------
+
+def _paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def read_png(path, background):
+    """Decodes a non-interlaced PNG into (width, height, [(r, g, b), ...])."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        raise ValueError("not a PNG file")
+
+    pos, idat, palette, trns = 8, [], None, None
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b"IHDR":
+            width, height, depth, colour, _, _, interlace = struct.unpack(">IIBBBBB", chunk)
+        elif kind == b"PLTE":
+            palette = [tuple(chunk[i:i + 3]) for i in range(0, len(chunk), 3)]
+        elif kind == b"tRNS":
+            trns = chunk
+        elif kind == b"IDAT":
+            idat.append(chunk)
+        elif kind == b"IEND":
+            break
+    if interlace:
+        raise ValueError("interlaced PNG is not supported")
+
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[colour]
+    bits = channels * depth
+    stride = (width * bits + 7) // 8
+    bpp = max(1, bits // 8)
+    raw = zlib.decompress(b"".join(idat))
+
+    rows, prev = [], bytearray(stride)
+    for y in range(height):
+        base = y * (stride + 1)
+        ftype = raw[base]
+        line = bytearray(raw[base + 1:base + 1 + stride])
+        for i in range(stride):
+            a = line[i - bpp] if i >= bpp else 0
+            b = prev[i]
+            c = prev[i - bpp] if i >= bpp else 0
+            if ftype == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif ftype == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif ftype == 3:
+                line[i] = (line[i] + ((a + b) >> 1)) & 0xFF
+            elif ftype == 4:
+                line[i] = (line[i] + _paeth(a, b, c)) & 0xFF
+        rows.append(line)
+        prev = line
+
+    def samples(line):
+        if depth == 8:
+            return list(line)
+        if depth == 16:
+            return [line[i] for i in range(0, len(line), 2)]
+        per_byte, mask = 8 // depth, (1 << depth) - 1
+        out = []
+        for byte in line:
+            for k in range(per_byte):
+                out.append((byte >> (8 - depth * (k + 1))) & mask)
+        return out
+
+    scale = 255 // ((1 << depth) - 1) if depth < 8 and colour != 3 else 1
+    pixels = []
+    for line in rows:
+        s = samples(line)
+        for x in range(width):
+            px = s[x * channels:(x + 1) * channels]
+            alpha = 255
+            if colour == 3:
+                r, g, b = palette[px[0]]
+                if trns is not None and px[0] < len(trns):
+                    alpha = trns[px[0]]
+            elif colour in (0, 4):
+                r = g = b = px[0] * scale
+                if colour == 4:
+                    alpha = px[1]
+            else:
+                r, g, b = px[0], px[1], px[2]
+                if colour == 6:
+                    alpha = px[3]
+            if alpha != 255:
+                r = (r * alpha + background[0] * (255 - alpha)) // 255
+                g = (g * alpha + background[1] * (255 - alpha)) // 255
+                b = (b * alpha + background[2] * (255 - alpha)) // 255
+            pixels.append((r, g, b))
+    return width, height, pixels
+
+
+def read_ppm(path, background):
+    """Decodes a binary (P6) or ASCII (P3) PPM into (width, height, [(r, g, b), ...])."""
+    with open(path, "rb") as f:
+        data = f.read()
+    magic = data[:2]
+    if magic not in (b"P6", b"P3"):
+        raise ValueError("not a P6/P3 PPM file")
+    text = re.sub(rb"#[^\n]*", b" ", data[2:]) if magic == b"P3" else data[2:]
+    tokens = re.finditer(rb"\S+", text)
+    width, height, maxval = (int(next(tokens).group()) for _ in range(3))
+    if magic == b"P3":
+        values = [int(next(tokens).group()) for _ in range(width * height * 3)]
+    else:
+        # a single whitespace byte separates the header from the samples
+        start = 2 + re.match(rb"(?:\s*\S+){3}\s", data[2:]).end()
+        if maxval < 256:
+            values = list(data[start:start + width * height * 3])
+        else:
+            values = list(struct.unpack(">%dH" % (width * height * 3),
+                                        data[start:start + width * height * 6]))
+    if maxval != 255:
+        values = [v * 255 // maxval for v in values]
+    pixels = [tuple(values[i:i + 3]) for i in range(0, len(values), 3)]
+    return width, height, pixels
+
+
+def read_image(path, background):
+    ext = os.path.splitext(path)[1].lower()
+    if ext == ".png":
+        return read_png(path, background)
+    if ext in (".ppm", ".pnm"):
+        return read_ppm(path, background)
+    raise ValueError("unsupported input type %s (use .png or .ppm)" % ext)
+
+
+# ---------------------------------------------------------------------------
+# Encoders
+# ---------------------------------------------------------------------------
+
+def to_rgb565(pixels):
+    return [(((r * 31 + 127) // 255) << 11) | (((g * 63 + 127) // 255) << 5) | ((b * 31 + 127) // 255)
+            for r, g, b in pixels]
+
+
+def qoi_hash(p):
+    return ((p >> 11) * 3 + ((p >> 5) & 0x3F) * 5 + (p & 0x1F) * 7) & 0x3F
+
+
+def encode_qoi565(colours):
+    """Encodes RGB565 values as the ILI9341_IMAGE_QOI565 stream (see ILI9341_Image.c)."""
+    out, index, prev, run = bytearray(), [0] * 64, 0, 0
+    last = len(colours) - 1
+    for i, p in enumerate(colours):
+        if p == prev:
+            run += 1
+            if run == 62 or i == last:
+                out.append(0xC0 | (run - 1))
+                run = 0
+            continue
+        if run:
+            out.append(0xC0 | (run - 1))
+            run = 0
+        h = qoi_hash(p)
+        if index[h] == p:
+            out.append(h)
+        else:
+            index[h] = p
+            dr = (((p >> 11) - (prev >> 11) + 16) & 0x1F) - 16
+            dg = ((((p >> 5) & 0x3F) - ((prev >> 5) & 0x3F) + 32) & 0x3F) - 32
+            db = (((p & 0x1F) - (prev & 0x1F) + 16) & 0x1F) - 16
+            if -2 <= dr <= 1 and -2 <= dg <= 1 and -2 <= db <= 1:
+                out.append(0x40 | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2))
+            else:
+                dr_dg, db_dg = dr - (dg >> 1), db - (dg >> 1)
+                if -8 <= dr_dg <= 7 and -8 <= db_dg <= 7:
+                    out += bytes((0x80 | (dg + 32), ((dr_dg + 8) << 4) | (db_dg + 8)))
+                else:
+                    out += bytes((0xFE, p >> 8, p & 0xFF))
+        prev = p
+    return bytes(out)
+
+
+def build_palette(colours, size):
+    """Returns (palette, {colour: index}) with at most size entries (median cut)."""
+    counts = {}
+    for c in colours:
+        counts[c] = counts.get(c, 0) + 1
+    if len(counts) <= size:
+        palette = sorted(counts)
+        return palette, {c: i for i, c in enumerate(palette)}
+
+    def channels(c):
+        return (c >> 11, (c >> 5) & 0x3F, c & 0x1F)
+
+    boxes = [list(counts)]
+    while len(boxes) < size:
+        # split the box with the most pixels along its widest channel
+        splittable = [b for b in boxes if len(b) > 1]
+        if not splittable:
+            break
+        box = max(splittable, key=lambda b: sum(counts[c] for c in b))
+        boxes.remove(box)
+        spans = [max(channels(c)[k] for c in box) - min(channels(c)[k] for c in box) for k in range(3)]
+        spans[1] //= 2          # green has one more bit
+        k = spans.index(max(spans))
+        box.sort(key=lambda c: channels(c)[k])
+        total, half, acc = sum(counts[c] for c in box), 0, 0
+        for half, c in enumerate(box):
+            acc += counts[c]
+            if acc * 2 >= total:
+                break
+        half = min(max(half, 1), len(box) - 1)
+        boxes += [box[:half], box[half:]]
+
+    palette, mapping = [], {}
+    for box in boxes:
+        weight = sum(counts[c] for c in box)
+        mean = [sum(channels(c)[k] * counts[c] for c in box) // weight for k in range(3)]
+        for c in box:
+            mapping[c] = len(palette)
+        palette.append((mean[0] << 11) | (mean[1] << 5) | mean[2])
+    return palette, mapping
+
+
+def encode_indexed(colours, width, height, bpp):
+    palette, mapping = build_palette(colours, 1 << bpp)
+    out = bytearray()
+    for y in range(height):
+        row = [mapping[c] for c in colours[y * width:(y + 1) * width]]
+        if bpp == 8:
+            out += bytes(row)
+        else:
+            row.append(0)
+            out += bytes((row[x] << 4) | row[x + 1] for x in range(0, width, 2))
+    return bytes(out), palette
+
+
+# ---------------------------------------------------------------------------
+# Output
+# ---------------------------------------------------------------------------
+
+def c_array(values, per_line, fmt):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append("\t" + ", ".join(fmt % v for v in values[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def convert(job):
+    path, fmt, name, outdir, background = job
+    width, height, pixels = read_image(path, background)
+    colours = to_rgb565(pixels)
+    raw_size = width * height * 2
+    guard = "ASSET_%s_H_" % name.upper()
+    upper = name.upper()
+    body, palette = [], None
+
+    if fmt == "rgb565":
+        data = b"".join(struct.pack(">H", c) for c in colours)
+    elif fmt == "rgb565le":
+        data = b"".join(struct.pack("<H", c) for c in colours)
+    elif fmt == "qoi565":
+        data = encode_qoi565(colours)
+    else:
+        data, palette = encode_indexed(colours, width, height, 8 if fmt == "index8" else 4)
+
+    stored = len(data) + (len(palette) * 2 if palette else 0)
+    header = os.path.join(outdir, name + ".h")
+
+    body.append("/*")
+    body.append(" * %s.h" % name)
+    body.append(" *")
+    body.append(" *  Generated by Tools/asset_compiler.py from %s, do not edit." % os.path.basename(path))
+    body.append(" *  %dx%d, %s, %d bytes (%.1f%% of raw RGB565)" % (width, height, fmt, stored, 100.0 * stored / raw_size))
+    body.append(" */")
+    body.append("")
+    body.append("#ifndef %s" % guard)
+    body.append("#define %s" % guard)
+    body.append("")
+    body.append('#include "ILI9341_Image.h"')
+    body.append("")
+    body.append("#define %s_WIDTH\t%d" % (upper, width))
+    body.append("#define %s_HEIGHT\t%d" % (upper, height))
+    body.append("")
+
+    if fmt == "rgb565le":
+        body.append("static const uint16_t %s[%d] = {" % (name, width * height))
+        body.append(c_array(colours, 12, "0x%04X"))
+        body.append("};")
+    else:
+        if palette:
+            body.append("static const uint16_t %s_palette[%d] = {" % (name, len(palette)))
+            body.append(c_array(palette, 12, "0x%04X"))
+            body.append("};")
+            body.append("")
+        body.append("static const uint8_t %s_data[%d] = {" % (name, len(data)))
+        body.append(c_array(list(data), 16, "0x%02X"))
+        body.append("};")
+        body.append("")
+        body.append("static const ILI9341_Image_TypeDef %s = {" % name)
+        body.append("\t.Width = %d," % width)
+        body.append("\t.Height = %d," % height)
+        body.append("\t.Format = %s," % FORMAT_IDS[fmt])
+        body.append("\t.Size = sizeof(%s_data)," % name)
+        body.append("\t.Data = %s_data," % name)
+        body.append("\t.Palette = %s," % ("%s_palette" % name if palette else "NULL"))
+        body.append("};")
+    body.append("")
+    body.append("#endif /* %s */" % guard)
+    body.append("")
+
+    with open(header, "w") as f:
+        f.write("\n".join(body))
+    return header, width, height, raw_size, stored
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="Convert PNG/PPM images into ILI9341 C headers.")
+    parser.add_argument("inputs", nargs="+", help="input .png or .ppm files")
+    parser.add_argument("-f", "--format", choices=FORMATS, default="rgb565", help="output encoding (default rgb565)")
+    parser.add_argument("-o", "--outdir", default=".", help="directory for the generated headers")
+    parser.add_argument("-n", "--name", help="C identifier (single input only, default: file name)")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count(), help="parallel conversions (default: all cores)")
+    parser.add_argument("--background", default="000000", help="RRGGBB colour behind transparent pixels")
+    args = parser.parse_args(argv)
+
+    if args.name and len(args.inputs) > 1:
+        parser.error("--name needs a single input")
+    background = tuple(int(args.background[i:i + 2], 16) for i in (0, 2, 4))
+
+    jobs = []
+    for path in args.inputs:
+        name = args.name or re.sub(r"\W", "_", os.path.splitext(os.path.basename(path))[0])
+        if name[0].isdigit():
+            name = "_" + name
+        jobs.append((path, args.format, name, args.outdir, background))
+
+    os.makedirs(args.outdir, exist_ok=True)
+    total_raw = total_stored = 0
+    failed = 0
+    with ProcessPoolExecutor(max_workers=max(1, args.jobs)) as pool:
+        for job, future in [(job, pool.submit(convert, job)) for job in jobs]:
+            try:
+                header, width, height, raw_size, stored = future.result()
+            except (OSError, ValueError, KeyError, StopIteration) as error:
+                print("%s: %s" % (job[0], error), file=sys.stderr)
+                failed += 1
+                continue
+            total_raw += raw_size
+            total_stored += stored
+            print("%s: %dx%d %s %d bytes, ratio %.2f:1" % (header, width, height, args.format, stored, raw_size / stored))
+
+    if len(jobs) > 1 and total_stored:
+        print("total: %d -> %d bytes, ratio %.2f:1" % (total_raw, total_stored, total_raw / total_stored))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())